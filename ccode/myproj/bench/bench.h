@@ -0,0 +1,280 @@
+// 基准测试共用的计时、统计和输出
+// 每个用例输出一行JSON（JSON Lines）：吞吐、延迟分位数、峰值内存，以及可用时的硬件计数器，
+// 按提交保存下来就能逐个提交比较。只有头文件，C和C++都能包含，每个基准程序一个翻译单元。
+//
+// 用法：
+//   BenchRun r;
+//   if (benchBegin(&r, "dijkstra", "grid-100x100")) {   // 被--filter过滤掉时返回0，跳过准备数据
+//       ...准备数据...
+//       while (benchMore(&r)) { benchStart(&r); 被测代码; benchStop(&r); }
+//       benchEnd(&r, 每次操作处理的元素数);
+//   }
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <io.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define BENCH_HAVE_PERF
+#endif
+
+#define BENCH_COUNTERS 4 // 周期、指令、缓存未命中、分支预测失败
+#define BENCH_INFO_LEN 256
+
+typedef struct BenchConfig {
+    double seconds; // 每个用例至少测这么久（计时部分之和）
+    int minIters, maxIters;
+    const char* filter; // 非NULL时只跑名字（bench/case）含该子串的用例
+    const char* commit; // 写进每行结果，便于跨提交比较
+    FILE* out; // 结果输出，被测代码自己的输出都丢到空设备
+    unsigned long long seed;
+} BenchConfig;
+
+static BenchConfig benchConfig = {0.5, 3, 1000000, NULL, "unknown", NULL, 20240527ULL};
+
+typedef struct BenchRun {
+    const char* bench;
+    char name[96];
+    long long* lat; // 每次操作的耗时（纳秒）
+    int n, cap;
+    long long total; // 计时部分之和
+    long long t0;
+    int perfFd[BENCH_COUNTERS]; // perfFd[0]为组长，打不开时为-1
+    char info[BENCH_INFO_LEN]; // 附加的"键":"值"对，已经是JSON片段
+} BenchRun;
+
+static inline long long benchNow(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER t;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (long long)((double)t.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+// 解析公共参数：--time 秒数、--min-iters N、--filter 子串、--seed N、--out 文件。
+// 结果写到原来的标准输出（或--out），标准输出本身重定向到空设备，避免被测程序的提示语混进结果
+static inline void benchInit(int argc, char* argv[]) {
+    const char* outPath = NULL;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--time") == 0) benchConfig.seconds = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--min-iters") == 0) benchConfig.minIters = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--filter") == 0) benchConfig.filter = argv[i + 1];
+        else if (strcmp(argv[i], "--seed") == 0) benchConfig.seed = strtoull(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--out") == 0) outPath = argv[i + 1];
+        else fprintf(stderr, "[提示] 忽略未知参数 %s\n", argv[i]);
+    }
+    const char* commit = getenv("BENCH_COMMIT");
+    if (commit != NULL && commit[0]) benchConfig.commit = commit;
+    fflush(stdout);
+    if (outPath != NULL) {
+        benchConfig.out = fopen(outPath, "a");
+        if (benchConfig.out == NULL) {
+            fprintf(stderr, "[错误] 无法写入结果文件 %s\n", outPath);
+            exit(1);
+        }
+    } else {
+#ifdef _WIN32
+        benchConfig.out = _fdopen(_dup(1), "w");
+#else
+        benchConfig.out = fdopen(dup(1), "w");
+#endif
+    }
+#ifdef _WIN32
+    if (freopen("NUL", "w", stdout) == NULL) fprintf(stderr, "[提示] 无法重定向标准输出\n");
+#else
+    if (freopen("/dev/null", "w", stdout) == NULL) fprintf(stderr, "[提示] 无法重定向标准输出\n");
+#endif
+}
+
+#ifdef BENCH_HAVE_PERF
+// 打开一组硬件计数器，只统计本线程的用户态；容器里通常没有权限，此时全部为-1，结果里counters为null
+static inline void benchOpenCounters(BenchRun* r) {
+    static const unsigned long long config[BENCH_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < BENCH_COUNTERS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config[i];
+        attr.disabled = i == 0; // 组长关着，整组随组长一起开关
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        r->perfFd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : r->perfFd[0], 0);
+        if (r->perfFd[i] < 0) {
+            for (int j = 0; j < i; j++) close(r->perfFd[j]);
+            for (int j = 0; j < BENCH_COUNTERS; j++) r->perfFd[j] = -1;
+            return;
+        }
+    }
+}
+#endif
+
+// 开始一个用例，被过滤掉时返回0。峰值内存从这里重新统计（Linux下清零VmHWM）
+static inline int benchBegin(BenchRun* r, const char* bench, const char* name) {
+    memset(r, 0, sizeof(*r));
+    r->bench = bench;
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    for (int i = 0; i < BENCH_COUNTERS; i++) r->perfFd[i] = -1;
+    if (benchConfig.filter != NULL) {
+        char full[160];
+        snprintf(full, sizeof(full), "%s/%s", bench, name);
+        if (strstr(full, benchConfig.filter) == NULL) return 0;
+    }
+    if (benchConfig.out == NULL) benchInit(0, NULL);
+#ifdef __linux__
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f != NULL) {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+#ifdef BENCH_HAVE_PERF
+    benchOpenCounters(r);
+#endif
+    r->cap = 1024;
+    r->lat = (long long*)malloc(r->cap * sizeof(long long));
+    return 1;
+}
+
+// 附加一条说明（如使用的内核、表宽），按字符串输出
+static inline void benchInfo(BenchRun* r, const char* key, const char* value) {
+    size_t len = strlen(r->info);
+    char* p = r->info + len;
+    size_t room = sizeof(r->info) - len;
+    int w = snprintf(p, room, "%s\"%s\":\"", len ? "," : "", key);
+    for (const char* s = value; *s && w + 3 < (int)room; s++) {
+        if (*s == '"' || *s == '\\') p[w++] = '\\';
+        p[w++] = *s;
+    }
+    if (w + 2 <= (int)room) {
+        p[w++] = '"';
+        p[w] = 0;
+    } else {
+        p[0] = 0; // 放不下就整条丢掉，保证JSON完整
+    }
+}
+
+// 是否还要再测一次：至少minIters次，计时部分累计到seconds为止
+static inline int benchMore(const BenchRun* r) {
+    if (r->n < benchConfig.minIters) return 1;
+    return r->n < benchConfig.maxIters && r->total < (long long)(benchConfig.seconds * 1e9);
+}
+
+static inline void benchStart(BenchRun* r) {
+#ifdef BENCH_HAVE_PERF
+    if (r->perfFd[0] >= 0) ioctl(r->perfFd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    r->t0 = benchNow();
+}
+
+static inline void benchStop(BenchRun* r) {
+    long long dt = benchNow() - r->t0;
+#ifdef BENCH_HAVE_PERF
+    if (r->perfFd[0] >= 0) ioctl(r->perfFd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    if (r->n == r->cap) {
+        r->cap *= 2;
+        r->lat = (long long*)realloc(r->lat, r->cap * sizeof(long long));
+    }
+    r->lat[r->n++] = dt;
+    r->total += dt;
+}
+
+static inline int benchCompareLL(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// 最近秩分位数
+static inline long long benchPercentile(const long long sorted[], int n, double q) {
+    int k = (int)(q * n + 0.999999);
+    if (k < 1) k = 1;
+    if (k > n) k = n;
+    return sorted[k - 1];
+}
+
+// 本用例期间的峰值常驻内存（KB）：优先读清零后的VmHWM，否则退回进程历史峰值
+static inline long benchPeakRSS(void) {
+#ifdef __linux__
+    FILE* f = fopen("/proc/self/status", "r");
+    if (f != NULL) {
+        char line[128];
+        long kb = -1;
+        while (fgets(line, sizeof(line), f))
+            if (strncmp(line, "VmHWM:", 6) == 0) kb = atol(line + 6);
+        fclose(f);
+        if (kb >= 0) return kb;
+    }
+#endif
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return (long)(pmc.PeakWorkingSetSize / 1024);
+    return -1;
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#ifdef __APPLE__
+    return (long)(ru.ru_maxrss / 1024);
+#else
+    return (long)ru.ru_maxrss;
+#endif
+#endif
+}
+
+// 结束用例并输出一行结果；items是每次操作处理的元素数（边、符号、表项、事件），用于换算元素吞吐
+static inline void benchEnd(BenchRun* r, double items) {
+    FILE* out = benchConfig.out;
+    int n = r->n;
+    double sec = r->total / 1e9;
+    qsort(r->lat, n, sizeof(long long), benchCompareLL);
+    fprintf(out, "{\"bench\":\"%s\",\"case\":\"%s\",\"commit\":\"%s\",\"iters\":%d,\"seconds\":%.6f",
+            r->bench, r->name, benchConfig.commit, n, sec);
+    fprintf(out, ",\"ops_per_s\":%.3f,\"items\":%.0f,\"items_per_s\":%.3f",
+            sec > 0 ? n / sec : 0.0, items, sec > 0 ? items * n / sec : 0.0);
+    if (n > 0)
+        fprintf(out, ",\"lat_ns\":{\"min\":%lld,\"p50\":%lld,\"p90\":%lld,\"p99\":%lld,\"max\":%lld,\"mean\":%.0f}",
+                r->lat[0], benchPercentile(r->lat, n, 0.5), benchPercentile(r->lat, n, 0.9),
+                benchPercentile(r->lat, n, 0.99), r->lat[n - 1], (double)r->total / n);
+    fprintf(out, ",\"peak_rss_kb\":%ld,\"counters\":", benchPeakRSS());
+#ifdef BENCH_HAVE_PERF
+    unsigned long long buf[1 + BENCH_COUNTERS];
+    if (r->perfFd[0] >= 0 && read(r->perfFd[0], buf, sizeof(buf)) == (ssize_t)sizeof(buf) && buf[0] == BENCH_COUNTERS) {
+        fprintf(out, "{\"cycles\":%llu,\"instructions\":%llu,\"cache_misses\":%llu,\"branch_misses\":%llu}",
+                buf[1], buf[2], buf[3], buf[4]);
+    } else {
+        fputs("null", out);
+    }
+    for (int i = 0; i < BENCH_COUNTERS; i++)
+        if (r->perfFd[i] >= 0) close(r->perfFd[i]);
+#else
+    fputs("null", out);
+#endif
+    fprintf(out, ",\"info\":{%s}}\n", r->info);
+    fflush(out);
+    free(r->lat);
+    r->lat = NULL;
+}
+
+#endif
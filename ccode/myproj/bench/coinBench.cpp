@@ -0,0 +1,48 @@
+// 纸币问题.cpp的基准：最少张数DP（minNotes），表宽按pickWidth选，和程序本身一致
+#define NO_MAIN
+#include "../test0527/纸币问题.cpp"
+#include "bench.h"
+#include "gen.h"
+
+static void benchMinNotes(GenDenomKind kind, int k, long long maxValue, long long w, int threads) {
+    char name[96];
+    snprintf(name, sizeof(name), "%s-%d-w%lld-t%d", genDenomName(kind), k, w, threads);
+    BenchRun r;
+    if (!benchBegin(&r, "minNotes", name)) return;
+    GenRng rng = {benchConfig.seed};
+    long long buf[4096];
+    int n = genDenominations(buf, 4096, kind, k, maxValue, &rng);
+    vector<long long> a(buf, buf + n);
+    int width = pickWidth(w / a[0]);
+    char info[32];
+    snprintf(info, sizeof(info), "%d", width);
+    benchInfo(&r, "width", info);
+    snprintf(info, sizeof(info), "%d", n);
+    benchInfo(&r, "notes", info);
+    benchInfo(&r, "kernel", useAVX2 ? "avx2" : "scalar");
+    volatile long long sink = 0;
+    while (benchMore(&r)) {
+        benchStart(&r);
+        switch (width) {
+            case 8: sink += minNotes<uint8_t>(a, w, threads); break;
+            case 16: sink += minNotes<uint16_t>(a, w, threads); break;
+            case 32: sink += minNotes<uint32_t>(a, w, threads); break;
+            default: sink += minNotes<uint64_t>(a, w, threads); break;
+        }
+        benchStop(&r);
+    }
+    benchEnd(&r, (double)w * n); // 元素为表项×面额，即松弛次数
+}
+
+int main(int argc, char* argv[]) {
+    benchInit(argc, argv);
+    int cores = max(1u, thread::hardware_concurrency());
+    benchMinNotes(GEN_DENOM_CURRENCY, 0, 100, 60000, 1); // 16位表
+    benchMinNotes(GEN_DENOM_CURRENCY, 0, 100, 1000000, 1);
+    benchMinNotes(GEN_DENOM_CURRENCY, 0, 100, 10000000, 1);
+    benchMinNotes(GEN_DENOM_RANDOM, 50, 1000, 1000000, 1);
+    benchMinNotes(GEN_DENOM_RANDOM, 500, 10000, 1000000, 1);
+    benchMinNotes(GEN_DENOM_POWERS, 3, 1000000, 10000000, 1);
+    if (cores > 1) benchMinNotes(GEN_DENOM_CURRENCY, 0, 100, 10000000, cores);
+    return 0;
+}
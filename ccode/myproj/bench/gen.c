@@ -0,0 +1,50 @@
+// 把基准测试用的合成数据写到标准输出，便于单独检查或交给各程序手动复现：
+//   gen grid 行数 列数 [种子]              路网CSV，可直接用citynetworkRoad加载
+//   gen geo 城市数 平均度数 [种子]
+//   gen scalefree 城市数 每城新增道路数 [种子]
+//   gen freq uniform|zipf|geometric 符号数 [种子]      每行一个频率
+//   gen notes currency|random|powers k 最大面额 金额 [种子]   纸币问题的输入：n w 和n个面额
+//   gen parking 车位数 事件数 [种子]        ParkingLot的完整输入
+#include "gen.h"
+
+static void usage() {
+    fprintf(stderr, "用法: gen grid|geo|scalefree|freq|notes|parking 参数... [种子]\n");
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) usage();
+    const char* kind = argv[1];
+    GenRng rng = {20240527ULL};
+    if (strcmp(kind, "grid") == 0 || strcmp(kind, "geo") == 0 || strcmp(kind, "scalefree") == 0 ||
+        strcmp(kind, "parking") == 0) {
+        if (argc > 4) rng.s = strtoull(argv[4], NULL, 10);
+        if (strcmp(kind, "grid") == 0) genGridRoads(stdout, atoi(argv[2]), atoi(argv[3]), &rng);
+        else if (strcmp(kind, "geo") == 0) genGeometricRoads(stdout, atoi(argv[2]), atof(argv[3]), &rng);
+        else if (strcmp(kind, "scalefree") == 0) genScaleFreeRoads(stdout, atoi(argv[2]), atoi(argv[3]), &rng);
+        else genParkingTrace(stdout, atoi(argv[2]), atoi(argv[3]), 5.0, &rng);
+    } else if (strcmp(kind, "freq") == 0) {
+        GenDist dist = strcmp(argv[2], "zipf") == 0 ? GEN_ZIPF : strcmp(argv[2], "geometric") == 0 ? GEN_GEOMETRIC : GEN_UNIFORM;
+        int n = atoi(argv[3]);
+        if (n <= 0) usage();
+        if (argc > 4) rng.s = strtoull(argv[4], NULL, 10);
+        long long* freq = (long long*)malloc(n * sizeof(long long));
+        genFrequencies(freq, n, dist, &rng);
+        for (int i = 0; i < n; i++) printf("%lld\n", freq[i]);
+        free(freq);
+    } else if (strcmp(kind, "notes") == 0) {
+        if (argc < 6) usage();
+        GenDenomKind dk = strcmp(argv[2], "random") == 0 ? GEN_DENOM_RANDOM :
+                          strcmp(argv[2], "powers") == 0 ? GEN_DENOM_POWERS : GEN_DENOM_CURRENCY;
+        int k = atoi(argv[3]);
+        long long w = atoll(argv[5]);
+        if (argc > 6) rng.s = strtoull(argv[6], NULL, 10);
+        long long a[4096];
+        int n = genDenominations(a, 4096, dk, k, atoll(argv[4]), &rng);
+        printf("%d %lld\n", n, w);
+        for (int i = 0; i < n; i++) printf("%lld%c", a[i], i + 1 < n ? ' ' : '\n');
+    } else {
+        usage();
+    }
+    return 0;
+}
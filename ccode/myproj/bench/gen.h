@@ -0,0 +1,290 @@
+// 基准测试用的合成数据：路网（网格、随机几何图、无标度图）、频率分布、面额集合和停车场进出记录
+// 同一个种子总是生成同样的数据，结果才能跨提交比较。只有头文件，C和C++都能包含
+#ifndef GEN_H
+#define GEN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// splitmix64，够快也够均匀
+typedef struct GenRng {
+    unsigned long long s;
+} GenRng;
+
+static inline unsigned long long genNext(GenRng* r) {
+    unsigned long long z = (r->s += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// [0, n)内的整数，n远小于2^64时偏差可以忽略
+static inline long long genBelow(GenRng* r, long long n) {
+    return (long long)(genNext(r) % (unsigned long long)n);
+}
+
+static inline double genUnit(GenRng* r) {
+    return (double)(genNext(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// 路网都按citynetworkRoad的CSV格式输出（城市1,城市2,距离），城市名为c0、c1……，返回道路数
+
+// rows×cols网格，每个路口连右边和下边，距离1~100
+static inline long long genGridRoads(FILE* f, int rows, int cols, GenRng* r) {
+    long long m = 0;
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++) {
+            int u = i * cols + j;
+            if (j + 1 < cols) {
+                fprintf(f, "c%d,c%d,%lld\n", u, u + 1, 1 + genBelow(r, 100));
+                m++;
+            }
+            if (i + 1 < rows) {
+                fprintf(f, "c%d,c%d,%lld\n", u, u + cols, 1 + genBelow(r, 100));
+                m++;
+            }
+        }
+    return m;
+}
+
+// 随机几何图：n个点均匀撒在单位正方形里，距离不超过半径的点之间有路，半径按平均度数degree取，
+// 距离为欧氏距离×10000取整。按半径分格，每个点只看相邻的9个格子。孤立的点不会出现在文件里
+static inline long long genGeometricRoads(FILE* f, int n, double degree, GenRng* r) {
+    double radius = sqrt(degree / (3.14159265358979 * n));
+    int side = (int)(1.0 / radius);
+    if (side < 1) side = 1;
+    if (side > 4096) side = 4096;
+    double* x = (double*)malloc(n * sizeof(double));
+    double* y = (double*)malloc(n * sizeof(double));
+    int* cellStart = (int*)calloc((size_t)side * side + 1, sizeof(int));
+    int* order = (int*)malloc(n * sizeof(int));
+    int* cell = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        x[i] = genUnit(r);
+        y[i] = genUnit(r);
+        int cx = (int)(x[i] * side), cy = (int)(y[i] * side);
+        cell[i] = cy * side + cx;
+        cellStart[cell[i] + 1]++;
+    }
+    for (int c = 0; c < side * side; c++) cellStart[c + 1] += cellStart[c];
+    int* fill = (int*)malloc((size_t)side * side * sizeof(int));
+    memcpy(fill, cellStart, (size_t)side * side * sizeof(int));
+    for (int i = 0; i < n; i++) order[fill[cell[i]]++] = i;
+    free(fill);
+
+    long long m = 0;
+    double r2 = radius * radius;
+    for (int i = 0; i < n; i++) {
+        int cx = cell[i] % side, cy = cell[i] / side;
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dx = -1; dx <= 1; dx++) {
+                int nx = cx + dx, ny = cy + dy;
+                if (nx < 0 || ny < 0 || nx >= side || ny >= side) continue;
+                int c = ny * side + nx;
+                for (int k = cellStart[c]; k < cellStart[c + 1]; k++) {
+                    int j = order[k];
+                    if (j <= i) continue;
+                    double ddx = x[i] - x[j], ddy = y[i] - y[j], d2 = ddx * ddx + ddy * ddy;
+                    if (d2 > r2) continue;
+                    fprintf(f, "c%d,c%d,%d\n", i, j, 1 + (int)(sqrt(d2) * 10000));
+                    m++;
+                }
+            }
+    }
+    free(x);
+    free(y);
+    free(cellStart);
+    free(order);
+    free(cell);
+    return m;
+}
+
+// 无标度图（Barabási–Albert）：每个新城市连m条路到已有城市，选中概率正比于度数，
+// 用“端点表里随机抽一项”实现；前m+1个城市连成环作为起点。距离1~100
+static inline long long genScaleFreeRoads(FILE* f, int n, int m, GenRng* r) {
+    if (m < 1) m = 1;
+    if (n < m + 2) n = m + 2;
+    int* ends = (int*)malloc(((size_t)2 * n * m + 2 * (m + 1)) * sizeof(int));
+    int* picked = (int*)malloc(m * sizeof(int));
+    long long e = 0, roads = 0;
+    for (int i = 0; i <= m; i++) {
+        int j = (i + 1) % (m + 1);
+        fprintf(f, "c%d,c%d,%lld\n", i, j, 1 + genBelow(r, 100));
+        ends[e++] = i;
+        ends[e++] = j;
+        roads++;
+    }
+    for (int v = m + 1; v < n; v++) {
+        int got = 0;
+        while (got < m) {
+            int u = ends[genBelow(r, e)];
+            int dup = 0;
+            for (int k = 0; k < got; k++) dup |= picked[k] == u;
+            if (!dup) picked[got++] = u;
+        }
+        for (int k = 0; k < m; k++) {
+            fprintf(f, "c%d,c%d,%lld\n", v, picked[k], 1 + genBelow(r, 100));
+            ends[e++] = v;
+            ends[e++] = picked[k];
+            roads++;
+        }
+    }
+    free(ends);
+    free(picked);
+    return roads;
+}
+
+typedef enum GenDist {
+    GEN_UNIFORM,   // 1~1000均匀
+    GEN_ZIPF,      // 第k常见的符号频率约为1e9/k
+    GEN_GEOMETRIC  // 频率按0.97的公比递减，码长差别最大
+} GenDist;
+
+static inline const char* genDistName(GenDist d) {
+    return d == GEN_UNIFORM ? "uniform" : d == GEN_ZIPF ? "zipf" : "geometric";
+}
+
+// 生成n个符号的频率（都不小于1），打乱顺序，和实际统计出来的直方图一样是无序的
+static inline void genFrequencies(long long freq[], int n, GenDist dist, GenRng* r) {
+    for (int i = 0; i < n; i++) {
+        if (dist == GEN_UNIFORM) {
+            freq[i] = 1 + genBelow(r, 1000);
+        } else if (dist == GEN_ZIPF) {
+            freq[i] = 1 + (long long)(1e9 / (i + 1));
+        } else {
+            double v = 1e15 * pow(0.97, i);
+            freq[i] = v < 1 ? 1 : (long long)v;
+        }
+    }
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)genBelow(r, i + 1);
+        long long t = freq[i];
+        freq[i] = freq[j];
+        freq[j] = t;
+    }
+}
+
+typedef enum GenDenomKind {
+    GEN_DENOM_CURRENCY, // 1、2、5进位的纸币体系，直到maxValue
+    GEN_DENOM_RANDOM,   // k种[1, maxValue]内的随机面额，一定含1
+    GEN_DENOM_POWERS    // k的各次幂（k>=2），直到maxValue
+} GenDenomKind;
+
+static inline const char* genDenomName(GenDenomKind kind) {
+    return kind == GEN_DENOM_CURRENCY ? "currency" : kind == GEN_DENOM_RANDOM ? "random" : "powers";
+}
+
+static inline int genCompareLL(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// 生成面额集合，升序去重后写入a（容量cap），返回种数
+static inline int genDenominations(long long a[], int cap, GenDenomKind kind, int k, long long maxValue, GenRng* r) {
+    int n = 0;
+    if (kind == GEN_DENOM_CURRENCY) {
+        static const int step[3] = {1, 2, 5};
+        for (long long base = 1; n < cap; base *= 10) {
+            int i;
+            for (i = 0; i < 3 && n < cap && base * step[i] <= maxValue; i++) a[n++] = base * step[i];
+            if (i < 3) break;
+        }
+    } else if (kind == GEN_DENOM_RANDOM) {
+        a[n++] = 1;
+        while (n < k && n < cap && n < maxValue) a[n++] = 1 + genBelow(r, maxValue);
+    } else {
+        if (k < 2) k = 2;
+        for (long long v = 1; v <= maxValue && n < cap; v *= k) a[n++] = v;
+    }
+    qsort(a, n, sizeof(long long), genCompareLL);
+    int m = 0;
+    for (int i = 0; i < n; i++)
+        if (m == 0 || a[i] != a[m - 1]) a[m++] = a[i];
+    return m;
+}
+
+// 从2024-01-01 00:00起的分钟数换成“年 月 日 时 分”
+static inline void genMinuteToDate(long long minute, int out[5]) {
+    static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    long long day = minute / 1440;
+    int year = 2024, month = 0;
+    for (;;) {
+        int leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        int len = days[month] + (month == 1 && leap);
+        if (day < len) break;
+        day -= len;
+        if (++month == 12) {
+            month = 0;
+            year++;
+        }
+    }
+    out[0] = year;
+    out[1] = month + 1;
+    out[2] = (int)day + 1;
+    out[3] = (int)(minute % 1440 / 60);
+    out[4] = (int)(minute % 60);
+}
+
+static inline void genPrintMinute(FILE* f, long long minute) {
+    int t[5];
+    genMinuteToDate(minute, t);
+    fprintf(f, "%d %d %d %d %d\n", t[0], t[1], t[2], t[3], t[4]);
+}
+
+// 停车场进出记录，按ParkingLot的菜单输入格式输出整个会话：车位数、收费标准，
+// 然后是events个“2 车牌 [入场时间]”或“3 车牌 [出场时间 [便道首车入场时间]]”，最后是退出。
+// 生成时模拟停车场和便道，保证每个输入都合法、时间不倒流；车数维持在车位数的1.2倍左右，便道经常有车
+static inline void genParkingTrace(FILE* f, int capacity, int events, double fee, GenRng* r) {
+    int* where = (int*)calloc(events + 1, sizeof(int)); // 0已离开，1停车场，2便道
+    int* present = (int*)malloc((events + 1) * sizeof(int)); // 在场车辆，删除时与末尾交换
+    int* slot = (int*)malloc((events + 1) * sizeof(int)); // 车辆在present中的位置
+    int* road = (int*)malloc((events + 1) * sizeof(int)); // 便道队列，离开的车懒删除
+    int count = 0, parked = 0, roadHead = 0, roadTail = 0, nextId = 0;
+    int target = capacity + capacity / 5 + 1;
+    long long now = 0;
+    fprintf(f, "%d\n%.2f\n", capacity, fee);
+    for (int e = 0; e < events; e++) {
+        now += genBelow(r, 30);
+        int arrive = count == 0 || genUnit(r) < (count < target ? 0.65 : 0.35);
+        if (arrive) {
+            int id = nextId++;
+            fprintf(f, "2\nA%06d\n", id);
+            if (parked < capacity) {
+                genPrintMinute(f, now);
+                where[id] = 1;
+                parked++;
+            } else {
+                where[id] = 2;
+                road[roadTail++] = id;
+            }
+            slot[id] = count;
+            present[count++] = id;
+        } else {
+            int id = present[genBelow(r, count)];
+            fprintf(f, "3\nA%06d\n", id);
+            if (where[id] == 1) {
+                genPrintMinute(f, now);
+                parked--;
+                while (roadHead < roadTail && where[road[roadHead]] != 2) roadHead++;
+                if (roadHead < roadTail) {
+                    genPrintMinute(f, now); // 便道首车随即进场
+                    where[road[roadHead++]] = 1;
+                    parked++;
+                }
+            }
+            where[id] = 0;
+            int last = present[--count];
+            present[slot[id]] = last;
+            slot[last] = slot[id];
+        }
+    }
+    fprintf(f, "7\n");
+    free(where);
+    free(present);
+    free(slot);
+    free(road);
+}
+
+#endif
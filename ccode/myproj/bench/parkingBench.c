@@ -0,0 +1,62 @@
+// ParkingLot的基准：按菜单输入格式生成进出记录，接到标准输入上回放，
+// 分别统计每次car_arrive和car_leave的耗时（含显示状态，和交互使用时一样）
+#define NO_MAIN
+#include "../proj2/ParkingLot.c"
+#include "bench.h"
+#include "gen.h"
+
+static void benchParking(int capacity, int events) {
+    char name[64];
+    snprintf(name, sizeof(name), "cap%d-%d", capacity, events);
+    BenchRun ra, rl;
+    int doArrive = benchBegin(&ra, "car_arrive", name);
+    int doLeave = benchBegin(&rl, "car_leave", name);
+    if (!doArrive && !doLeave) return;
+
+    GenRng rng = {benchConfig.seed};
+    FILE* trace = tmpfile();
+    if (trace == NULL) {
+        fprintf(stderr, "[错误] 无法创建临时文件\n");
+        exit(1);
+    }
+    genParkingTrace(trace, capacity, events, 5.0, &rng);
+    fflush(trace);
+    rewind(trace);
+    dup2(fileno(trace), 0); // 回放记录：stdinReader读的就是这个文件
+    FastReader* in = stdinReader();
+    readerOpenFd(in, 0);
+
+    Stack park;
+    stack_init(&park);
+    Queue road;
+    queue_init(&road);
+    memset(&last_time, 0, sizeof(last_time));
+    readerInt(in, &PARK_CAPACITY);
+    input_per();
+    int choice;
+    while (readerInt(in, &choice) && choice != 7) {
+        if (choice == 2) {
+            if (doArrive) benchStart(&ra);
+            car_arrive(&park, &road);
+            if (doArrive) benchStop(&ra);
+        } else {
+            if (doLeave) benchStart(&rl);
+            car_leave(&park, &road);
+            if (doLeave) benchStop(&rl);
+        }
+    }
+    if (doArrive) benchEnd(&ra, 1);
+    if (doLeave) benchEnd(&rl, 1);
+    while (!stack_empty(&park)) stack_pop(&park);
+    while (!queue_empty(&road)) queue_pop(&road);
+    readerClose(in);
+    fclose(trace);
+}
+
+int main(int argc, char* argv[]) {
+    benchInit(argc, argv);
+    benchParking(10, 20000);
+    benchParking(100, 20000);
+    benchParking(1000, 5000);
+    return 0;
+}
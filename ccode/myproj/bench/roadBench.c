@@ -0,0 +1,103 @@
+// citynetworkRoad的基准：dijkstra（稠密矩阵内核和堆优化两条路径）和buildHuffmanTree
+// 路网由gen.h生成CSV后经loadGraphFile加载，与命令行加载文件走同一条路径
+#define NO_MAIN
+#include "../test0527/citynetworkRoad.c"
+#include "bench.h"
+#include "gen.h"
+
+typedef enum RoadKind { ROAD_GRID, ROAD_GEO, ROAD_SCALEFREE } RoadKind;
+
+// 生成路网写到临时文件再加载，成功返回0
+static int loadGenerated(RoadKind kind, int a, int b, GenRng* rng) {
+    char path[260];
+#ifdef _WIN32
+    snprintf(path, sizeof(path), "roadbench-%d.csv", (int)GetCurrentProcessId());
+    FILE* f = fopen(path, "w");
+#else
+    const char* dir = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/roadbench-XXXXXX", dir && dir[0] ? dir : "/tmp");
+    int fd = mkstemp(path);
+    FILE* f = fd >= 0 ? fdopen(fd, "w") : NULL;
+#endif
+    if (f == NULL) {
+        fprintf(stderr, "[错误] 无法创建临时路网文件\n");
+        return -1;
+    }
+    if (kind == ROAD_GRID) genGridRoads(f, a, b, rng);
+    else if (kind == ROAD_GEO) genGeometricRoads(f, a, b, rng);
+    else genScaleFreeRoads(f, a, b, rng);
+    fclose(f);
+    int rc = loadGraphFile(path);
+    remove(path);
+    return rc;
+}
+
+static void benchDijkstra(const char* name, RoadKind kind, int a, int b) {
+    BenchRun r;
+    if (!benchBegin(&r, "dijkstra", name)) return;
+    GenRng rng = {benchConfig.seed};
+    if (loadGenerated(kind, a, b, &rng) != 0) {
+        benchEnd(&r, 0);
+        return;
+    }
+    int n = graph.numCities;
+    int* dist = (int*)malloc(n * sizeof(int));
+    int* prev = (int*)malloc(n * sizeof(int));
+    if (graph.matrix != NULL) {
+        dijkstra(0, dist, prev); // 第一次调用时选内核
+        benchInfo(&r, "kernel", dijkstraKernel());
+    } else {
+        benchInfo(&r, "kernel", "heap");
+    }
+    char cities[32];
+    snprintf(cities, sizeof(cities), "%d", n);
+    benchInfo(&r, "cities", cities);
+    while (benchMore(&r)) {
+        int start = (int)genBelow(&rng, n);
+        benchStart(&r);
+        dijkstra(start, dist, prev);
+        benchStop(&r);
+    }
+    benchEnd(&r, getCSR()->offset[n]); // 元素为有向弧
+    free(dist);
+    free(prev);
+    freeGraph();
+}
+
+static void benchHuffman(int n, GenDist dist) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s-%d", genDistName(dist), n);
+    BenchRun r;
+    if (!benchBegin(&r, "buildHuffmanTree", name)) return;
+    GenRng rng = {benchConfig.seed};
+    int* symbols = (int*)malloc(n * sizeof(int));
+    long long* freqs = (long long*)malloc(n * sizeof(long long));
+    HuffmanNode* pool = (HuffmanNode*)malloc((2 * (size_t)n - 1) * sizeof(HuffmanNode));
+    for (int i = 0; i < n; i++) symbols[i] = i;
+    genFrequencies(freqs, n, dist, &rng);
+    while (benchMore(&r)) {
+        benchStart(&r);
+        buildHuffmanTree(symbols, freqs, n, pool);
+        benchStop(&r);
+    }
+    benchEnd(&r, n); // 元素为符号
+    free(symbols);
+    free(freqs);
+    free(pool);
+}
+
+int main(int argc, char* argv[]) {
+    benchInit(argc, argv);
+    benchDijkstra("grid-40x40", ROAD_GRID, 40, 40);
+    benchDijkstra("geo-2000-deg8", ROAD_GEO, 2000, 8);
+    benchDijkstra("grid-300x300", ROAD_GRID, 300, 300);
+    benchDijkstra("geo-100000-deg8", ROAD_GEO, 100000, 8);
+    benchDijkstra("scalefree-100000-m3", ROAD_SCALEFREE, 100000, 3);
+    static const int sizes[3] = {256, 4096, 262144};
+    for (int s = 0; s < 3; s++) {
+        benchHuffman(sizes[s], GEN_UNIFORM);
+        benchHuffman(sizes[s], GEN_ZIPF);
+        benchHuffman(sizes[s], GEN_GEOMETRIC);
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// citynetworkRoad的正确性检查：方向优化BFS与朴素队列BFS逐城市比较层数
+// 覆盖有向（DIMACS弧）和无向（CSV道路）两种路网，有向图专门构造入弧和出弧不对称、会切换到自底向上的情况
+// make check 运行，全部一致时返回0
+#define NO_MAIN
+#include "../test0527/citynetworkRoad.c"
+#include "gen.h"
+
+static int failures = 0;
+
+// 写到临时文件再用loadGraphFile加载，与命令行加载走同一条路径；suffix决定按哪种格式解析
+static int loadText(const char* text, const char* suffix) {
+    char path[260];
+    const char* dir = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/roadcheck-%d%s", dir && dir[0] ? dir : "/tmp", (int)getpid(), suffix);
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        fprintf(stderr, "[错误] 无法创建临时路网文件\n");
+        return -1;
+    }
+    fputs(text, f);
+    fclose(f);
+    int rc = loadGraphFile(path);
+    remove(path);
+    return rc;
+}
+
+// 只沿出弧走的朴素BFS
+static void plainBFS(int start, int level[]) {
+    CSRGraph* g = getCSR();
+    int* queue = (int*)malloc(g->n * sizeof(int));
+    for (int i = 0; i < g->n; i++) level[i] = -1;
+    int head = 0, tail = 0;
+    level[start] = 0;
+    queue[tail++] = start;
+    while (head < tail) {
+        int u = queue[head++];
+        for (int e = g->offset[u]; e < g->offset[u+1]; e++)
+            if (level[g->adj[e]] < 0) {
+                level[g->adj[e]] = level[u] + 1;
+                queue[tail++] = g->adj[e];
+            }
+    }
+    free(queue);
+}
+
+static void checkAllStarts(const char* name, int starts) {
+    int n = graph.numCities;
+    int* expect = (int*)malloc(n * sizeof(int));
+    int* got = (int*)malloc(n * sizeof(int));
+    int bad = 0;
+    for (int s = 0; s < starts && s < n; s++) {
+        plainBFS(s, expect);
+        int count = 0;
+        for (int i = 0; i < n; i++) count += expect[i] >= 0;
+        int reached = reachabilityBFS(s, got);
+        if (reached != count || memcmp(expect, got, n * sizeof(int)) != 0) bad++;
+    }
+    printf("%s %s: %d个城市，%d个起点不一致\n", bad ? "[错误]" : "[提示]", name, n, bad);
+    failures += bad;
+    free(expect);
+    free(got);
+}
+
+// 1->2..21，2..21->1，22..41->2：22..41从1出发不可达，但它们的出弧指向前沿
+static void checkOneWayFan() {
+    char* text = (char*)malloc(4096);
+    int len = sprintf(text, "p sp 41 60\n");
+    for (int v = 2; v <= 21; v++) len += sprintf(text + len, "a 1 %d 1\na %d 1 1\n", v, v);
+    for (int v = 22; v <= 41; v++) len += sprintf(text + len, "a %d 2 1\n", v);
+    if (loadText(text, ".gr") == 0) checkAllStarts("有向扇形", 41);
+    else failures++;
+    free(text);
+    freeGraph();
+}
+
+// 随机有向图：少数枢纽城市出度很大，前沿很快变大，触发自底向上
+static void checkRandomDirected(int n, int arcs, GenRng* rng) {
+    char* text = (char*)malloc((size_t)arcs * 40 + 64);
+    int len = sprintf(text, "p sp %d %d\n", n, arcs);
+    for (int i = 0; i < arcs; i++) {
+        int u = genBelow(rng, 4) == 0 ? (int)genBelow(rng, 8) : (int)genBelow(rng, n);
+        len += sprintf(text + len, "a %d %d 1\n", u + 1, (int)genBelow(rng, n) + 1);
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "随机有向图-%d-%d", n, arcs);
+    if (loadText(text, ".gr") == 0) checkAllStarts(name, 64);
+    else failures++;
+    free(text);
+    freeGraph();
+}
+
+static void checkUndirected(GenRng* rng) {
+    char* buf = NULL;
+    size_t size = 0;
+    FILE* f = open_memstream(&buf, &size);
+    genScaleFreeRoads(f, 5000, 3, rng);
+    fclose(f);
+    if (loadText(buf, ".csv") == 0) checkAllStarts("无向无标度路网", 64);
+    else failures++;
+    free(buf);
+    freeGraph();
+}
+
+int main() {
+    GenRng rng = {12345};
+    checkOneWayFan();
+    checkRandomDirected(2000, 6000, &rng);
+    checkRandomDirected(20000, 100000, &rng);
+    checkUndirected(&rng);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,271 @@
+// 各个命令行小工具共用的快速输入
+// 普通文件（包括重定向进来的标准输入）整个映射进内存直接解析，管道和终端按块read，
+// 整数用SWAR一次判断、转换8个数字，记号按8字节一组找分隔符。
+// 只有头文件，C和C++都能直接包含；同一程序里读标准输入要全部走stdinReader()，不能再混用scanf/getchar/cin
+#ifndef FASTREADER_H
+#define FASTREADER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define READER_BLOCK (1 << 16) // 块读时每次读入的字节数
+#define READER_SLACK 24 // 剩余字节不少于它时一个整数一定完整在缓冲区内，可以整块按8字节读
+
+typedef struct FastReader {
+    const char* cur; // 下一个未读字节
+    const char* end;
+    char* buf; // 块读缓冲，映射时为NULL
+    size_t mapSize; // 映射长度，0表示没有映射
+    int fd;
+    int ownsFd; // 由readerOpenFile打开的描述符，关闭时一并关掉
+    int eof;
+} FastReader;
+
+// 把剩下的字节挪到缓冲区开头再读一块；交互使用时先把提示语刷出去，否则用户看不到提示就阻塞在read上
+static inline int readerRefill(FastReader* r) {
+    if (r->eof || r->buf == NULL) return 0;
+    size_t left = (size_t)(r->end - r->cur);
+    memmove(r->buf, r->cur, left);
+    fflush(stdout);
+#ifdef _WIN32
+    int got = _read(r->fd, r->buf + left, READER_BLOCK);
+#else
+    ssize_t got = read(r->fd, r->buf + left, READER_BLOCK);
+#endif
+    if (got <= 0) {
+        r->eof = 1;
+        got = 0;
+    }
+    r->cur = r->buf;
+    r->end = r->buf + left + got;
+    return got > 0;
+}
+
+// 普通文件整个映射，失败或不是普通文件时退回块读
+static inline void readerOpenFd(FastReader* r, int fd) {
+    memset(r, 0, sizeof(*r));
+    r->fd = fd;
+#ifndef _WIN32
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        off_t pos = lseek(fd, 0, SEEK_CUR);
+        if (pos < 0) pos = 0;
+        if (st.st_size <= pos) {
+            r->eof = 1;
+            return;
+        }
+        void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL // 严格标准模式（如-std=c11）下系统头文件不声明madvise，只是少了预读提示
+            madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+            r->mapSize = (size_t)st.st_size;
+            r->cur = (const char*)data + pos;
+            r->end = (const char*)data + st.st_size;
+            r->eof = 1; // 没有更多数据可读了
+            return;
+        }
+    }
+#endif
+    r->buf = (char*)malloc(2 * READER_BLOCK);
+    r->cur = r->end = r->buf;
+}
+
+// 打开文件，失败返回-1
+static inline int readerOpenFile(FastReader* r, const char* path) {
+#ifdef _WIN32
+    int fd = _open(path, _O_RDONLY | _O_BINARY);
+#else
+    int fd = open(path, O_RDONLY);
+#endif
+    if (fd < 0) return -1;
+    readerOpenFd(r, fd);
+    r->ownsFd = 1;
+    return 0;
+}
+
+static inline void readerClose(FastReader* r) {
+#ifndef _WIN32
+    if (r->mapSize > 0) munmap((void*)(r->end - r->mapSize), r->mapSize);
+#endif
+    free(r->buf);
+#ifdef _WIN32
+    if (r->ownsFd) _close(r->fd);
+#else
+    if (r->ownsFd) close(r->fd);
+#endif
+    memset(r, 0, sizeof(*r));
+}
+
+// 标准输入共用的读取器，第一次使用时打开
+static inline FastReader* stdinReader(void) {
+    static FastReader in;
+    static int opened = 0;
+    if (!opened) {
+#ifdef _WIN32
+        _setmode(0, _O_BINARY);
+#endif
+        readerOpenFd(&in, 0);
+        opened = 1;
+    }
+    return &in;
+}
+
+// 同getchar，结束返回EOF
+static inline int readerChar(FastReader* r) {
+    if (r->cur == r->end && !readerRefill(r)) return EOF;
+    return (unsigned char)*r->cur++;
+}
+
+static inline int readerPeek(FastReader* r) {
+    if (r->cur == r->end && !readerRefill(r)) return EOF;
+    return (unsigned char)*r->cur;
+}
+
+// 跳过空白，返回下一个字符（不消耗），没有了返回EOF
+static inline int readerSkipSpace(FastReader* r) {
+    for (;;) {
+        while (r->cur < r->end && (unsigned char)*r->cur <= ' ') r->cur++;
+        if (r->cur < r->end) return (unsigned char)*r->cur;
+        if (!readerRefill(r)) return EOF;
+    }
+}
+
+static inline unsigned long long readerLoad8(const char* p) {
+    unsigned long long x;
+    memcpy(&x, p, 8);
+    return x;
+}
+
+// 8个字节里哪些不是数字：减'0'后大于9的字节加上0x76会进位到最高位，本身>=0x80的也算
+static inline unsigned long long readerNonDigitMask(unsigned long long x) {
+    x ^= 0x3030303030303030ULL;
+    return ((x + 0x7676767676767676ULL) | x) & 0x8080808080808080ULL;
+}
+
+// 把低k个字节里的k个数字（先出现的在低位）转成数值：先左移补前导零凑满8位，再两两、四四、八八合并
+static inline unsigned long long readerDigits8(unsigned long long x, int k) {
+    x = (x & 0x0F0F0F0F0F0F0F0FULL) << (8 * (8 - k));
+    x = (x * 10 + (x >> 8)) & 0x00FF00FF00FF00FFULL;
+    x = (x * 100 + (x >> 16)) & 0x0000FFFF0000FFFFULL;
+    return (x * 10000 + (x >> 32)) & 0xFFFFFFFFULL;
+}
+
+static const unsigned long long readerPow10[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+// 读一个带符号十进制整数，同scanf("%lld")，成功返回1，没有整数返回0
+static inline int readerLongLong(FastReader* r, long long* out) {
+    int c = readerSkipSpace(r);
+    if (c == EOF) return 0;
+    int neg = 0;
+    if (c == '-' || c == '+') {
+        neg = c == '-';
+        r->cur++;
+        c = readerPeek(r);
+    }
+    if (c < '0' || c > '9') return 0;
+    unsigned long long v = 0;
+    if (r->end - r->cur >= READER_SLACK) {
+        // 整数最多20位，剩余足够时不会越过缓冲区末尾，每次处理8个字节
+        for (;;) {
+            unsigned long long x = readerLoad8(r->cur);
+            unsigned long long mask = readerNonDigitMask(x);
+            int k = mask ? __builtin_ctzll(mask) >> 3 : 8;
+            if (k > 0) {
+                v = v * readerPow10[k] + readerDigits8(x, k);
+                r->cur += k;
+            }
+            if (k < 8 || r->end - r->cur < 8) break;
+        }
+        while (r->cur < r->end && *r->cur >= '0' && *r->cur <= '9') v = v * 10 + (unsigned)(*r->cur++ - '0');
+    } else {
+        // 接近末尾时逐字节读，数字被块边界截断时readerPeek会接着读下一块
+        while ((c = readerPeek(r)) >= '0' && c <= '9') {
+            v = v * 10 + (unsigned)(c - '0');
+            r->cur++;
+        }
+    }
+    *out = neg ? -(long long)v : (long long)v;
+    return 1;
+}
+
+static inline int readerInt(FastReader* r, int* out) {
+    long long v;
+    if (!readerLongLong(r, &v)) return 0;
+    *out = (int)v;
+    return 1;
+}
+
+// 读一个空白分隔的记号到dst（最多cap-1字节），同scanf("%s")，没有了返回0。
+// 按8字节一组找第一个<=' '的字节，UTF-8多字节字符的字节都>=0x80，不会被当成分隔符
+static inline int readerToken(FastReader* r, char* dst, size_t cap) {
+    if (readerSkipSpace(r) == EOF) return 0;
+    size_t len = 0;
+    for (;;) {
+        const char* p = r->cur;
+        while (r->end - p >= 8) {
+            unsigned long long x = readerLoad8(p);
+            unsigned long long mask = (x - 0x2121212121212121ULL) & ~x & 0x8080808080808080ULL;
+            if (mask) {
+                p += __builtin_ctzll(mask) >> 3;
+                break;
+            }
+            p += 8;
+        }
+        while (p < r->end && (unsigned char)*p > ' ') p++;
+        size_t n = (size_t)(p - r->cur);
+        if (len + n > cap - 1) n = len < cap - 1 ? cap - 1 - len : 0;
+        memcpy(dst + len, r->cur, n);
+        len += n;
+        int more = p == r->end; // 记号可能被块边界截断
+        r->cur = p;
+        if (!more || !readerRefill(r)) break;
+    }
+    dst[len] = 0;
+    return 1;
+}
+
+// 同fgets：读到换行（保留）或cap-1个字节，一个字节也没有时返回NULL
+static inline char* readerLine(FastReader* r, char* dst, size_t cap) {
+    size_t len = 0;
+    while (len + 1 < cap) {
+        if (r->cur == r->end && !readerRefill(r)) break;
+        size_t n = (size_t)(r->end - r->cur);
+        if (n > cap - 1 - len) n = cap - 1 - len;
+        const char* nl = (const char*)memchr(r->cur, '\n', n);
+        if (nl != NULL) n = (size_t)(nl - r->cur) + 1;
+        memcpy(dst + len, r->cur, n);
+        len += n;
+        r->cur += n;
+        if (nl != NULL) break;
+    }
+    if (len == 0) return NULL;
+    dst[len] = 0;
+    return dst;
+}
+
+// 丢掉本行剩下的内容（含换行）
+static inline void readerSkipLine(FastReader* r) {
+    int c;
+    while ((c = readerChar(r)) != EOF && c != '\n') ;
+}
+
+// 读一个浮点数，同scanf("%lf")
+static inline int readerDouble(FastReader* r, double* out) {
+    char tok[64], *endp;
+    if (!readerToken(r, tok, sizeof(tok))) return 0;
+    *out = strtod(tok, &endp);
+    return endp != tok;
+}
+
+#endif
@@ -0,0 +1,194 @@
+// 热点路径的计数器和周期计时器，编译时定义ENABLE_STATS才生效，否则下面的宏都是空操作，不占任何开销
+// 包含前先列出本程序的计数器：
+//   #define STATS_COUNTERS(X) X(STAT_SPLIT, "bptree.split") X(STAT_RELAX, "dijkstra.relax")
+//   #include "../common/stats.h"
+// STATS_ADD(id, n)给计数器加n；STATS_TIMER_BEGIN(t)/STATS_TIMER_END(id, t)给计数器加1并累计经过的周期数。
+// 计数块是线程局部的，线程第一次计数时挂到全局链表上，汇总时把所有块相加，线程退出后块仍保留；
+// 热点循环里宜先用局部变量累计，结束时再STATS_ADD一次。
+// statsReport()打印表格，statsWriteJSON()输出一行JSON。设置环境变量STATS_EXPORT=文件（STATS_INTERVAL=秒，默认10）
+// 后，statsInit()会启动后台线程定期往文件追加一行JSON，程序退出时再追加一行最终结果，供长时间运行的批处理使用
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+#ifdef ENABLE_STATS
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifndef STATS_COUNTERS
+#error "包含stats.h之前需要用STATS_COUNTERS(X)列出计数器"
+#endif
+
+#if defined(__cplusplus)
+#define STATS_TLS thread_local
+#elif defined(_MSC_VER)
+#define STATS_TLS __declspec(thread)
+#else
+#define STATS_TLS __thread
+#endif
+
+#define STATS_ENUM(id, name) id,
+#define STATS_NAME(id, name) name,
+enum { STATS_COUNTERS(STATS_ENUM) STATS_COUNT };
+static const char* const statsNames[STATS_COUNT] = { STATS_COUNTERS(STATS_NAME) };
+
+typedef struct StatsBlock {
+    unsigned long long count[STATS_COUNT];
+    unsigned long long cycles[STATS_COUNT];
+    struct StatsBlock* next;
+} StatsBlock;
+
+static StatsBlock* statsHead; // 所有线程的计数块
+static STATS_TLS StatsBlock* statsLocal;
+
+// 本线程第一次计数：分配计数块，无锁地压到链表头
+static StatsBlock* statsAttach(void) {
+    StatsBlock* b = (StatsBlock*)calloc(1, sizeof(StatsBlock));
+    b->next = __atomic_load_n(&statsHead, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&statsHead, &b->next, b, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) ;
+    statsLocal = b;
+    return b;
+}
+
+static inline StatsBlock* statsBlock(void) {
+    StatsBlock* b = statsLocal;
+    return b != NULL ? b : statsAttach();
+}
+
+// 只有本线程写自己的计数块，汇总线程只读，所以用不带lock前缀的原子读写就够了
+static inline void statsBump(unsigned long long* slot, unsigned long long n) {
+    __atomic_store_n(slot, __atomic_load_n(slot, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+// x86上读时间戳计数器，其他平台退回纳秒时钟
+static inline unsigned long long statsCycles(void) {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+#define STATS_ADD(id, n) statsBump(&statsBlock()->count[id], (unsigned long long)(n))
+#define STATS_TIMER_BEGIN(t) unsigned long long t = statsCycles()
+#define STATS_TIMER_END(id, t) do { \
+        StatsBlock* statsB_ = statsBlock(); \
+        statsBump(&statsB_->cycles[id], statsCycles() - (t)); \
+        statsBump(&statsB_->count[id], 1); \
+    } while (0)
+
+// 把所有线程的计数相加
+static inline void statsTotals(unsigned long long count[], unsigned long long cycles[]) {
+    memset(count, 0, STATS_COUNT * sizeof(unsigned long long));
+    memset(cycles, 0, STATS_COUNT * sizeof(unsigned long long));
+    for (StatsBlock* b = __atomic_load_n(&statsHead, __ATOMIC_ACQUIRE); b != NULL; b = b->next)
+        for (int i = 0; i < STATS_COUNT; i++) {
+            count[i] += __atomic_load_n(&b->count[i], __ATOMIC_RELAXED);
+            cycles[i] += __atomic_load_n(&b->cycles[i], __ATOMIC_RELAXED);
+        }
+}
+
+static inline void statsReport(FILE* out) {
+    unsigned long long count[STATS_COUNT], cycles[STATS_COUNT];
+    statsTotals(count, cycles);
+    fprintf(out, "%-28s %14s %16s %12s\n", "计数器", "次数", "周期", "周期/次");
+    for (int i = 0; i < STATS_COUNT; i++) {
+        fprintf(out, "%-28s %14llu", statsNames[i], count[i]);
+        if (cycles[i] > 0) fprintf(out, " %16llu %12.0f", cycles[i], count[i] ? (double)cycles[i] / count[i] : 0.0);
+        fprintf(out, "\n");
+    }
+}
+
+// 一行JSON：{"time":秒,"counters":{"名字":{"count":N,"cycles":C},...}}，cycles只对计时器输出
+static inline void statsWriteJSON(FILE* out) {
+    unsigned long long count[STATS_COUNT], cycles[STATS_COUNT];
+    statsTotals(count, cycles);
+    fprintf(out, "{\"time\":%lld,\"counters\":{", (long long)time(NULL));
+    for (int i = 0; i < STATS_COUNT; i++) {
+        fprintf(out, "%s\"%s\":{\"count\":%llu", i ? "," : "", statsNames[i], count[i]);
+        if (cycles[i] > 0) fprintf(out, ",\"cycles\":%llu", cycles[i]);
+        fputc('}', out);
+    }
+    fputs("}}\n", out);
+}
+
+static const char* statsExportPath;
+static int statsExportSeconds;
+
+static void statsExportOnce(void) {
+    FILE* f = fopen(statsExportPath, "a");
+    if (f == NULL) return;
+    statsWriteJSON(f);
+    fclose(f);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI statsExportLoop(LPVOID arg) {
+    (void)arg;
+    for (;;) {
+        Sleep(statsExportSeconds * 1000);
+        statsExportOnce();
+    }
+    return 0;
+}
+#else
+static void* statsExportLoop(void* arg) {
+    (void)arg;
+    for (;;) {
+        sleep(statsExportSeconds);
+        statsExportOnce();
+    }
+    return NULL;
+}
+#endif
+
+// 在main开头调用：按STATS_EXPORT启动定期导出
+static inline void statsInit(void) {
+    statsExportPath = getenv("STATS_EXPORT");
+    if (statsExportPath == NULL || statsExportPath[0] == 0) return;
+    const char* interval = getenv("STATS_INTERVAL");
+    statsExportSeconds = interval != NULL && atoi(interval) > 0 ? atoi(interval) : 10;
+    atexit(statsExportOnce);
+#ifdef _WIN32
+    HANDLE h = CreateThread(NULL, 0, statsExportLoop, NULL, 0, NULL);
+    if (h != NULL) CloseHandle(h);
+#else
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, statsExportLoop, NULL) == 0) pthread_detach(tid);
+#endif
+}
+
+#else // 未开启统计：计数和计时都编译成空操作
+
+#define STATS_ADD(id, n) ((void)(n))
+#define STATS_TIMER_BEGIN(t) ((void)0)
+#define STATS_TIMER_END(id, t) ((void)0)
+
+static inline void statsInit(void) {}
+
+static inline void statsReport(FILE* out) {
+    fprintf(out, "[提示] 编译时未定义ENABLE_STATS，没有统计数据（用-DENABLE_STATS重新编译）\n");
+}
+
+static inline void statsWriteJSON(FILE* out) {
+    fputs("{}\n", out);
+}
+
+#endif
+
+#endif
@@ -1,7 +1,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <time.h>
+#include "../common/fastreader.h"
+// 运行统计（编译时定义ENABLE_STATS才计数，见common/stats.h）
+#define STATS_COUNTERS(X) \
+    X(STAT_SHUFFLE, "car_leave.shuffle") \
+    X(STAT_ROAD_SHUFFLE, "car_leave.roadShuffle") \
+    X(STAT_STACK_ALLOC, "stack.alloc") \
+    X(STAT_QUEUE_ALLOC, "queue.alloc") \
+    X(STAT_HISTORY_ALLOC, "history.blockAlloc") \
+    X(STAT_HISTORY_SCAN, "history.blocksScanned")
+#include "../common/stats.h"
 #define MAX_PLATE 20
 int PARK_CAPACITY ; // 由用户输入停车位
 float per;
@@ -61,6 +72,7 @@ int stack_empty(Stack *s) { return s->size == 0; }
 int stack_size(Stack *s) { return s->size; }
 void stack_push(Stack *s, Car *car) {
     Car *node = (Car*)malloc(sizeof(Car));
+    STATS_ADD(STAT_STACK_ALLOC, 1);
     *node = *car;
     node->next = s->top;
     s->top = node;
@@ -101,6 +113,7 @@ int queue_size(Queue *q) {
 }
 void queue_push(Queue *q, Car *car) {
     QueueNode *node = (QueueNode*)malloc(sizeof(QueueNode));
+    STATS_ADD(STAT_QUEUE_ALLOC, 1);
     node->car = *car;
     node->next = NULL;
     if (q->rear) q->rear->next = node;
@@ -143,7 +156,12 @@ void show_status(Stack *park, Queue *road) {
 // 车辆到达
 void input_time(Time *t) {
     printf("请输入时间(年 月 日 时 分): ");
-    scanf("%d%d%d%d%d", &t->year, &t->month, &t->day, &t->hour, &t->min);
+    FastReader* in = stdinReader();
+    readerInt(in, &t->year);
+    readerInt(in, &t->month);
+    readerInt(in, &t->day);
+    readerInt(in, &t->hour);
+    readerInt(in, &t->min);
 }
 
 Time last_time = {0,0,0,0,0}; // 全局变量，记录最近一次进出车辆的时间
@@ -166,10 +184,254 @@ int time_geq(Time *t1, Time *t2) {
     return tt1 >= tt2;
 }
 
+// ---------------- 停车记录 ----------------
+// 每次车辆从停车场离开时追加一条记录（车牌、入场、出场、收费），按列分块存放。
+// 出场时间只和本车的入场时间比较过，各列都不保证有序（先来的车可能很晚才走），按时段查询时逐块比较
+// 每块的最小/最大值跳过不相关的块。按车牌查询走每个车牌自己的行号表，只碰它所在的块
+#define HISTORY_BLOCK 1024 // 每块的记录数
+#define HISTORY_PRINT_LIMIT 50 // 查询结果最多列出的条数
+
+// 一块停车记录，按列存放，附带各列的最小/最大值和收费合计
+typedef struct {
+    int count;
+    int plate[HISTORY_BLOCK]; // 车牌编号，见plate_id
+    int entry[HISTORY_BLOCK]; // 入场时间，自1970-01-01 00:00起的分钟数
+    int exit[HISTORY_BLOCK];  // 出场时间
+    float fee[HISTORY_BLOCK];
+    int minEntry, maxEntry, minExit, maxExit;
+    double feeSum;
+} HistoryBlock;
+
+// 一个车牌及它的全部记录在历史中的行号（升序）
+typedef struct {
+    char plate[MAX_PLATE];
+    int *rows;
+    int count, cap;
+} PlateRecord;
+
+HistoryBlock **history = NULL;
+int historyBlocks = 0, historyCap = 0;
+PlateRecord *plates = NULL; // 按编号存放的车牌
+int numPlates = 0, plateCap = 0;
+int *plateSlots = NULL; // 车牌->编号的开放定址哈希表，-1为空槽
+int slotCap = 0;
+
+unsigned plate_hash(const char *s) {
+    unsigned h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// 查车牌编号，create非0时不存在就新建，否则返回-1
+int plate_id(const char *plate, int create) {
+    if (slotCap == 0 && !create) return -1;
+    if (2 * (numPlates + 1) > slotCap) { // 装填率不超过一半
+        int newCap = slotCap ? slotCap * 2 : 64;
+        int *slots = (int*)malloc(newCap * sizeof(int));
+        for (int i = 0; i < newCap; i++) slots[i] = -1;
+        for (int id = 0; id < numPlates; id++) {
+            unsigned i = plate_hash(plates[id].plate) & (newCap - 1);
+            while (slots[i] != -1) i = (i + 1) & (newCap - 1);
+            slots[i] = id;
+        }
+        free(plateSlots);
+        plateSlots = slots;
+        slotCap = newCap;
+    }
+    unsigned i = plate_hash(plate) & (slotCap - 1);
+    while (plateSlots[i] != -1) {
+        if (strcmp(plates[plateSlots[i]].plate, plate) == 0) return plateSlots[i];
+        i = (i + 1) & (slotCap - 1);
+    }
+    if (!create) return -1;
+    if (numPlates == plateCap) {
+        plateCap = plateCap ? plateCap * 2 : 64;
+        plates = (PlateRecord*)realloc(plates, plateCap * sizeof(PlateRecord));
+    }
+    PlateRecord *p = &plates[numPlates];
+    strcpy(p->plate, plate);
+    p->rows = NULL;
+    p->count = p->cap = 0;
+    plateSlots[i] = numPlates;
+    return numPlates++;
+}
+
+// 公历日期换成自1970-01-01起的天数
+long long days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    long long yoe = y - era * 400;
+    long long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// 时间换成分钟数，与时区无关
+int time_minutes(Time *t) {
+    return (int)(days_from_civil(t->year, t->month, t->day) * 1440 + t->hour * 60 + t->min);
+}
+
+// 分钟数格式化为"年-月-日 时:分"
+void format_minutes(int minutes, char buf[]) {
+    long long z = (long long)(minutes >= 0 ? minutes / 1440 : (minutes - 1439) / 1440) + 719468;
+    int rest = minutes - (int)(z - 719468) * 1440;
+    long long era = (z >= 0 ? z : z - 146096) / 146097;
+    long long doe = z - era * 146097;
+    long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long long mp = (5 * doy + 2) / 153;
+    int d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    int m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    int y = (int)(yoe + era * 400 + (m <= 2));
+    sprintf(buf, "%04d-%02d-%02d %02d:%02d", y, m, d, rest / 60, rest % 60);
+}
+
+// 追加一条停车记录
+void history_append(const char *plate, Time *in, Time *out, float fee) {
+    HistoryBlock *b = historyBlocks > 0 ? history[historyBlocks - 1] : NULL;
+    if (b == NULL || b->count == HISTORY_BLOCK) {
+        if (historyBlocks == historyCap) {
+            historyCap = historyCap ? historyCap * 2 : 16;
+            history = (HistoryBlock**)realloc(history, historyCap * sizeof(HistoryBlock*));
+        }
+        b = (HistoryBlock*)malloc(sizeof(HistoryBlock));
+        STATS_ADD(STAT_HISTORY_ALLOC, 1);
+        b->count = 0;
+        b->minEntry = b->minExit = INT_MAX;
+        b->maxEntry = b->maxExit = INT_MIN;
+        b->feeSum = 0;
+        history[historyBlocks++] = b;
+    }
+    int id = plate_id(plate, 1);
+    int entry = time_minutes(in), leave = time_minutes(out), i = b->count++;
+    b->plate[i] = id;
+    b->entry[i] = entry;
+    b->exit[i] = leave;
+    b->fee[i] = fee;
+    if (entry < b->minEntry) b->minEntry = entry;
+    if (entry > b->maxEntry) b->maxEntry = entry;
+    if (leave < b->minExit) b->minExit = leave;
+    if (leave > b->maxExit) b->maxExit = leave;
+    b->feeSum += fee;
+    PlateRecord *p = &plates[id];
+    if (p->count == p->cap) {
+        p->cap = p->cap ? p->cap * 2 : 4;
+        p->rows = (int*)realloc(p->rows, p->cap * sizeof(int));
+    }
+    p->rows[p->count++] = (historyBlocks - 1) * HISTORY_BLOCK + i;
+}
+
+void print_session(HistoryBlock *b, int i) {
+    char in[32], out[32];
+    format_minutes(b->entry[i], in);
+    format_minutes(b->exit[i], out);
+    printf("[%s] %s -> %s, 收费%.1f元\n", plates[b->plate[i]].plate, in, out, b->fee[i]);
+}
+
+// 时段[from, to]内在停车场停过的车辆：入场不晚于to且出场不早于from，还在场的车也算
+void history_parked_between(Stack *park, int from, int to) {
+    int total = 0, scanned = 0;
+    for (int k = 0; k < historyBlocks; k++) {
+        HistoryBlock *b = history[k];
+        if (b->minEntry > to || b->maxExit < from) continue; // 整块都是to之后才入场或from之前就离开的
+        scanned++;
+        for (int i = 0; i < b->count; i++) {
+            if (b->entry[i] <= to && b->exit[i] >= from) {
+                if (total < HISTORY_PRINT_LIMIT) print_session(b, i);
+                total++;
+            }
+        }
+    }
+    STATS_ADD(STAT_HISTORY_SCAN, scanned);
+    for (Car *c = park->top; c; c = c->next) {
+        int entry = time_minutes(&c->in_time);
+        if (entry > to) continue;
+        if (total < HISTORY_PRINT_LIMIT) {
+            char in[32];
+            format_minutes(entry, in);
+            printf("[%s] %s -> 仍在场\n", c->plate, in);
+        }
+        total++;
+    }
+    if (total > HISTORY_PRINT_LIMIT) printf("...\n");
+    printf("共%d辆次（检查了%d/%d块记录）\n", total, scanned, historyBlocks);
+}
+
+// 出场时间在[from, to]内的营收；整块落在时段内时直接用块的收费合计，整块在时段外时跳过
+void history_revenue(int from, int to) {
+    double sum = 0;
+    int count = 0, scanned = 0;
+    for (int k = 0; k < historyBlocks; k++) {
+        HistoryBlock *b = history[k];
+        if (b->maxExit < from || b->minExit > to) continue;
+        if (b->minExit >= from && b->maxExit <= to) {
+            sum += b->feeSum;
+            count += b->count;
+            continue;
+        }
+        scanned++;
+        for (int i = 0; i < b->count; i++) {
+            if (b->exit[i] >= from && b->exit[i] <= to) {
+                sum += b->fee[i];
+                count++;
+            }
+        }
+    }
+    STATS_ADD(STAT_HISTORY_SCAN, scanned);
+    printf("出场%d辆次，营收%.1f元（逐条检查了%d/%d块记录）\n", count, sum, scanned, historyBlocks);
+}
+
+// 按车牌列出全部停车记录
+void history_by_plate(const char *plate) {
+    int id = plate_id(plate, 0);
+    if (id < 0) {
+        printf("没有车辆[%s]的停车记录\n", plate);
+        return;
+    }
+    PlateRecord *p = &plates[id];
+    double sum = 0;
+    for (int j = 0; j < p->count; j++) {
+        HistoryBlock *b = history[p->rows[j] / HISTORY_BLOCK];
+        int i = p->rows[j] % HISTORY_BLOCK;
+        if (j < HISTORY_PRINT_LIMIT) print_session(b, i);
+        sum += b->fee[i];
+    }
+    if (p->count > HISTORY_PRINT_LIMIT) printf("...\n");
+    printf("车辆[%s]共停车%d次，合计收费%.1f元\n", plate, p->count, sum);
+}
+
+// 停车记录查询菜单
+void history_menu(Stack *park) {
+    int op = 0;
+    printf("\n1. 某时段内停过车的车辆\n2. 某时段营收（按出场时间）\n3. 按车牌查询停车记录\n请选择: ");
+    if (!readerInt(stdinReader(), &op)) return;
+    if (op == 3) {
+        char plate[MAX_PLATE];
+        printf("请输入车牌号: ");
+        readerToken(stdinReader(), plate, MAX_PLATE);
+        history_by_plate(plate);
+        return;
+    }
+    if (op != 1 && op != 2) {
+        printf("无效选择\n");
+        return;
+    }
+    Time from, to;
+    printf("时段开始，");
+    input_time(&from);
+    printf("时段结束，");
+    input_time(&to);
+    if (op == 1) history_parked_between(park, time_minutes(&from), time_minutes(&to));
+    else history_revenue(time_minutes(&from), time_minutes(&to));
+}
+
 void car_arrive(Stack *park, Queue *road) {
     Car car;
     printf("请输入车牌号: ");
-    scanf("%s", car.plate);
+    readerToken(stdinReader(), car.plate, MAX_PLATE);
     if (stack_size(park) < PARK_CAPACITY) {
         // 输入时间必须大于等于last_time
         while (1) {
@@ -200,7 +462,7 @@ void car_arrive(Stack *park, Queue *road) {
 void car_leave(Stack *park, Queue *road) {
     char plate[MAX_PLATE];
     printf("请输入离开车牌号: ");
-    scanf("%s", plate);
+    readerToken(stdinReader(), plate, MAX_PLATE);
     int pos = -1;
     Car *target = stack_find(park, plate, &pos);
     if (!target) {
@@ -215,6 +477,7 @@ void car_leave(Stack *park, Queue *road) {
                     Car c = queue_pop(road);
                     if (strcmp(c.plate, plate) != 0) {
                         queue_push(&tmp, &c);
+                        STATS_ADD(STAT_ROAD_SHUFFLE, 1);
                         printf("车辆[%s]出队，暂存到临时队列\n", c.plate);
                     } else {
                         printf("车辆[%s]出队，离开便道\n", c.plate);
@@ -237,6 +500,7 @@ void car_leave(Stack *park, Queue *road) {
     Stack temp; stack_init(&temp);
     int i;
     printf("--为让[%s]离开，后进车辆依次出栈到临时区--\n", plate);
+    STATS_ADD(STAT_SHUFFLE, pos);
     for (i = 0; i < pos; ++i) {
         Car tmpCar = stack_pop(park);
         stack_push(&temp, &tmpCar);
@@ -272,6 +536,7 @@ void car_leave(Stack *park, Queue *road) {
     }
     int hours = time_diff_hour(&out_car.in_time, &out_time);
     float fee = hours * per; // 每小时收费
+    history_append(out_car.plate, &out_car.in_time, &out_time, fee);
     if (hours == 0) {
         printf("车辆[%s]离开, 停车不足1小时, 不收费\n", out_car.plate);
     } else {
@@ -320,32 +585,46 @@ void car_leave(Stack *park, Queue *road) {
     show_status(park, road);
 }
 
+// 读收费标准，没读到时保持原值
+void input_per() {
+    double v;
+    if (readerDouble(stdinReader(), &v)) per = (float)v;
+}
+
+#ifndef NO_MAIN // 基准测试直接包含本文件时不编译main
 int main() {
     Stack park; 
     stack_init(&park);
     Queue road; 
     queue_init(&road);
     int choice;
+    statsInit();
     printf("========欢迎使用停车场管理系统========\n");
     printf("请输入停车场车位数: ");
-    scanf("%d", &PARK_CAPACITY);
+    readerInt(stdinReader(), &PARK_CAPACITY);
     printf ("请输入每小时收费标准: ");
-    scanf("%f", &per);
+    input_per();
     while (1) {
-        printf("\n1. 显示停车场状态\n2. 车辆到达\n3. 车辆离开\n4. 修改每小时收费标准\n5. 退出\n请选择: ");
-        scanf("%d", &choice);
+        printf("\n1. 显示停车场状态\n2. 车辆到达\n3. 车辆离开\n4. 修改每小时收费标准\n5. 运行统计\n6. 停车记录查询\n7. 退出\n请选择: ");
+        if (!readerInt(stdinReader(), &choice)) break; // 输入结束
         switch (choice) {
             case 1: show_status(&park, &road); break;
             case 2: car_arrive(&park, &road); break;
             case 3: car_leave(&park, &road); break;
             case 4:
                 printf("请输入新的每小时收费标准: ");
-                scanf("%f", &per);
+                input_per();
                 printf("已修改为每小时%.2f元\n", per);
                 break;
-            case 5: exit(0);
+            case 5:
+                printf("\n--运行统计--\n");
+                statsReport(stdout);
+                break;
+            case 6: history_menu(&park); break;
+            case 7: exit(0);
             default: printf("无效选择\n");
         }
     }
     return 0;
 }
+#endif
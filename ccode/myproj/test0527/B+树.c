@@ -1,5 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "../common/fastreader.h"
+// 运行统计（编译时定义ENABLE_STATS才计数，见common/stats.h）
+#define STATS_COUNTERS(X) \
+    X(STAT_SPLIT, "splitChild") \
+    X(STAT_LEAF_SPLIT, "splitChild.leaf")
+#include "../common/stats.h"
 #define M 3 // B+树的阶数
 
 // B+树节点结构体
@@ -30,6 +37,7 @@ int findInsertPos(BPTreeNode* node, int key) {
 
 // 分裂节点
 void splitChild(BPTreeNode* parent, int idx) {
+    STATS_TIMER_BEGIN(timer);
     BPTreeNode* child = parent->children[idx];
     BPTreeNode* newChild = createNode(child->isLeaf);
     int mid = M/2;
@@ -52,6 +60,8 @@ void splitChild(BPTreeNode* parent, int idx) {
         parent->keys[i] = parent->keys[i-1];
     parent->keys[idx] = newChild->keys[0];
     parent->numKeys++;
+    STATS_ADD(STAT_LEAF_SPLIT, child->isLeaf);
+    STATS_TIMER_END(STAT_SPLIT, timer);
 }
 
 // 插入非满节点
@@ -107,17 +117,20 @@ void printLeaves(BPTreeNode* root) {
     printf("\n");
 }
 
-// 主函数示例
-int main() {
+// 主函数示例，带--stats时最后打印运行统计
+int main(int argc, char* argv[]) {
     BPTreeNode* root = NULL;
-    int n, key;
+    int n = 0, key;
+    FastReader* in = stdinReader();
+    statsInit();
     printf("请输入要插入的关键字数量: ");
-    scanf("%d", &n);
+    readerInt(in, &n);
     printf("请输入%d个整数: ", n);
     for (int i = 0; i < n; i++) {
-        scanf("%d", &key);
+        if (!readerInt(in, &key)) break;
         root = insert(root, key);
     }
     printLeaves(root);
+    if (argc > 1 && strcmp(argv[1], "--stats") == 0) statsReport(stdout);
     return 0;
 }
@@ -2,14 +2,62 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <time.h>
+#include <stddef.h>
+#include "../common/fastreader.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <pthread.h>
+#endif
 
-#define MAX_CITIES 20
+#define MAX_CITIES 20 // 交互式创建地图时的城市数上限
 #define MAX_NAME_LENGTH 50
 #define INF INT_MAX
+#define DENSE_MATRIX_LIMIT 2048 // 城市数超过该值时不分配邻接矩阵
+#define PRINT_LIMIT 100 // 城市数超过该值时只输出摘要
+#define FROZEN_BATCH 16 // 批量查找时交错推进的查询数
+#define HUFFMAN_LINEAR_MIN 1024 // 符号数达到该值时用基数排序加两队列合并建赫夫曼树
+#define HUFFMAN_RADIX_BITS 11
+#define HUFFMAN_MAX_CODE_LEN 32 // 码长上限，解码时64位窗口总能看到一个完整码字
+#define HUFFMAN_TABLE_BITS 12 // 解码查找表的索引位数
+#define HUFFMAN_TABLE_SYMS 3 // 每个表项最多一次解出的符号数
+#define HUFFMAN_LOG_MAGIC "CNRHUF1"
+#define LOG_STREAM_MAGIC "CNRHUFS"
+#define LOG_STREAM_CHUNK 4096 // 流式压缩每次读入、统计和编码的行数
+#define LOG_STREAM_SEGMENT (1 << 20) // 一段码流最多的行数，换编码表时也会提前结束一段
+#define LOG_STREAM_MERGE_MIN 65536 // 线程局部直方图至少每隔这么多行合并一次
+
+// 运行统计（编译时定义ENABLE_STATS才计数，见common/stats.h）
+#define STATS_COUNTERS(X) \
+    X(STAT_DIJKSTRA_DENSE, "dijkstra.dense") \
+    X(STAT_DIJKSTRA_HEAP, "dijkstra.heap") \
+    X(STAT_RELAX, "dijkstra.relax") \
+    X(STAT_IMPROVE, "dijkstra.improve") \
+    X(STAT_HEAP_PUSH, "heap.push") \
+    X(STAT_HEAP_DECREASE, "heap.decreaseKey") \
+    X(STAT_HEAP_POP, "heap.pop") \
+    X(STAT_RING_ALLOC, "levelQueue.alloc") \
+    X(STAT_RING_BYTES, "levelQueue.bytes")
+#include "../common/stats.h"
 
 // 城市结构
 typedef struct City {
-    char name[MAX_NAME_LENGTH];
+    int nameOffset;   // 城市名在名字池graph.names中的偏移
+    unsigned hash;    // 城市名的哈希值，扩容时无需重新计算
     int index;
 } City;
 
@@ -25,90 +73,358 @@ typedef struct AdjList {
     AdjListNode* head;
 } AdjList;
 
+// 邻接表节点池中的一块，节点按块分配、随图一起释放
+typedef struct NodeBlock {
+    struct NodeBlock* next;
+    int used, cap;
+    AdjListNode nodes[];
+} NodeBlock;
+
 // 图结构
 typedef struct Graph {
     int numCities;
-    City cities[MAX_CITIES];
-    int matrix[MAX_CITIES][MAX_CITIES];
-    AdjList* array; // 邻接表
+    int cityCap;    // cities数组容量
+    City* cities;
+    int** matrix;   // 邻接矩阵，城市数超过DENSE_MATRIX_LIMIT时为NULL
+    AdjList* array; // 邻接表，批量加载后为NULL，首次修改时由CSR展开
+    NodeBlock* nodeBlocks; // 邻接表节点池
+    int directed;   // 1表示有向图（DIMACS弧），0表示无向道路
+    int* component; // 并查集父节点，压缩后即所在连通分量的编号（根城市）
+    int componentsDirty; // 删除道路后连通分量可能分裂，需要重新计算
+    int version;    // 每次修改边时递增，用于判断派生结构是否过期
+    char* names;    // 名字池：所有城市名以'\0'结尾依次存放
+    int namesLen, namesCap;
+    int* nameSlots; // 城市名->编号的开放定址哈希表，-1表示空槽
+    int slotCap;    // 槽数（2的幂）
+    const char* snapshot; // 非NULL时城市表、名字索引、CSR和连通分量直接指向映射的快照文件
+    size_t snapshotSize;
 } Graph;
 
+// 压缩邻接表（CSR），遍历引擎使用的只读视图
+typedef struct CSRGraph {
+    int n;
+    int version;    // 构建时对应的graph.version
+    int *offset;    // 长度n+1，城市i的邻居位于adj[offset[i]..offset[i+1])
+    int *adj;       // 邻居编号（每行按编号升序）
+    int *weight;    // 对应道路距离
+} CSRGraph;
+
+// 最短路径树缓存项（以起点为键）
+typedef struct PathCacheEntry {
+    int source;
+    int *dist, *prev;
+    struct PathCacheEntry *lruPrev, *lruNext; // LRU双向链表，表头为最近使用
+    struct PathCacheEntry *hashNext;          // 哈希桶链
+} PathCacheEntry;
+
+#define PATH_CACHE_BUCKETS 1024
+#define PATH_CACHE_DEFAULT_BUDGET (64LL << 20) // 默认缓存上限64MB
+
+// 最短路径树LRU缓存，graph.version变化时整体失效
+typedef struct PathCache {
+    PathCacheEntry* buckets[PATH_CACHE_BUCKETS];
+    PathCacheEntry *head, *tail;
+    int count;
+    int version;            // 缓存内容对应的graph.version
+    long long bytesUsed, budget;
+    long long hits, misses, evictions, invalidations;
+} PathCache;
+
+// 地图快照文件头。快照中各数据段与内存中的数组布局完全相同，
+// 以相对文件开头的偏移定位（与映射地址无关），打开时无需反序列化
+#define SNAPSHOT_MAGIC "CNRSNAP"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_ALIGN 64
+typedef struct SnapshotHeader {
+    char magic[8];
+    unsigned version;
+    unsigned byteOrder;     // 用于检测生成快照的机器字节序是否一致
+    int numCities, numArcs;
+    int namesLen, slotCap;
+    int directed, hasMatrix;
+    long long citiesOff, namesOff, slotsOff;   // 城市表、名字池、名字哈希槽
+    long long offsetOff, adjOff, weightOff;    // CSR
+    long long componentOff, matrixOff;         // 连通分量编号、邻接矩阵（无则为0）
+    long long fileSize;
+} SnapshotHeader;
+
+// 批量查询时每个工作线程独占的Dijkstra工作区
+// dist/prev/pos在查询之间保持初始值，只复位touched中记录的城市
+typedef struct QueryScratch {
+    int *dist, *prev, *heap, *pos, *touched, *path;
+    int touchedCount;
+} QueryScratch;
+
+// 一条批量查询：城市名直接指向输入缓冲区，结果由工作线程格式化为一行输出
+typedef struct BatchQuery {
+    const char *from, *to;
+    int fromLen, toLen;
+    char* result;
+    int resultLen;
+} BatchQuery;
+
+// 位图（访问标记、前沿集合）
+typedef unsigned long long Bitmap;
+#define BITMAP_WORDS(n) (((n) + 63) / 64)
+
 // 赫夫曼树节点
 typedef struct HuffmanNode {
-    char cityCode;
-    int frequency;
+    int symbol; // 叶子的符号（交互输入时为城市编码字母），内部节点为-1
+    long long frequency;
     struct HuffmanNode *left, *right;
 } HuffmanNode;
 
-// 队列节点（用于层次遍历）
-typedef struct QueueNode {
-    void *node;
+// 建树用的小顶堆元素，按(频率, 槽位)比较
+typedef struct HuffmanHeapItem {
+    long long frequency;
+    int slot;
+} HuffmanHeapItem;
+
+// 解码表项：以HUFFMAN_TABLE_BITS位为索引，记录能完整解出的符号（最多HUFFMAN_TABLE_SYMS个）及共用的位数
+// count为0表示码字比索引位数长，需要逐个码长比较
+typedef struct HuffmanDecodeEntry {
+    int symbols[HUFFMAN_TABLE_SYMS];
+    unsigned char count;
+    unsigned char bits;
+} HuffmanDecodeEntry;
+
+// 范式赫夫曼编码：码字完全由各符号的码长决定，同码长的符号按编号依次取连续码字
+typedef struct HuffmanCode {
+    int numSymbols;
+    int maxLen;
+    unsigned char* length; // 每个符号的码长
+    unsigned* code; // 每个符号的码字（低length位有效）
+    int* sorted; // 按(码长, 符号)排序的符号
+    int lenCount[HUFFMAN_MAX_CODE_LEN + 1]; // 每种码长的符号数
+    int firstIndex[HUFFMAN_MAX_CODE_LEN + 1]; // 每种码长在sorted中的起点
+    unsigned long long firstCode[HUFFMAN_MAX_CODE_LEN + 1]; // 每种码长的第一个码字
+    HuffmanDecodeEntry* table;
+} HuffmanCode;
+
+// 压缩查询日志的文件头，其后依次为名字表（每个名字以'\n'结尾）、各符号码长、码流（末尾补8字节0）
+typedef struct HuffmanLogHeader {
+    char magic[8];
+    int numSymbols;
+    int maxLen;
+    long long numLines;
+    long long dictBytes;
+    long long streamBytes;
+    int trailingNewline; // 原文件最后一行是否以换行结尾
+    int reserved;
+} HuffmanLogHeader;
+
+// 城市名字典：按首次出现的顺序编号，开放寻址哈希索引
+// 没有插入时可以多线程同时查找
+typedef struct NameDict {
+    char* text; // 名字依次存放
+    size_t textLen, textCap;
+    size_t* start;
+    int* len;
+    int count, cap;
+    int* table;
+    int tableCap;
+} NameDict;
+
+// 流式压缩文件由若干段组成，每段开头是该段使用的编码表（各符号码长），其后为码流（末尾补8字节0）
+// 编码表覆盖编号小于numSymbols的城市名，编号numSymbols为转义符：其后跟32位长度和原样的名字字节
+typedef struct LogSegmentHeader {
+    int numLines;
+    int numSymbols;
+    long long streamBytes;
+} LogSegmentHeader;
+
+// 位写入器（高位在前），缓冲区自动扩容
+typedef struct BitWriter {
+    unsigned char* buf;
+    size_t pos, cap;
+    unsigned long long acc;
+    int nbits;
+} BitWriter;
+
+// 后台重建编码表的任务：按频率快照建表，完成后通过result原子地发布
+typedef struct CodeRebuildJob {
+    long long* freqs; // 含转义符
+    int n;
+    int maxLen;
+    HuffmanCode** result;
+} CodeRebuildJob;
+
+// 层次遍历用的环形队列项
+typedef struct LevelItem {
+    const void *node;
     char position; // 'L'左孩子, 'R'右孩子, ' '根节点
-    int isAVL; // 1表示AVL节点，0表示Huffman节点
-    struct QueueNode *next;
-} QueueNode;
+} LevelItem;
+
+// 环形队列（用于层次遍历）：容量为2的幂，满时翻倍，多次遍历之间复用同一块缓冲
+typedef struct RingQueue {
+    LevelItem *items;
+    int cap, head, count;
+} RingQueue;
 
-// 队列（用于层次遍历）
-typedef struct Queue {
-    QueueNode *front, *rear;
-} Queue;
+// 层次遍历的访问函数，level为层号（根为0）
+typedef void (*LevelVisitor)(const void *node, char position, int level, void *ctx);
 
 // AVL树节点
 typedef struct AVLNode{
     int cityNumber;
     struct AVLNode *left, *right;
     int height;
+    int size; // 子树节点数，用于按排名查询
 }AVLNode; 
 
+// AVL树中序迭代器：显式栈保存尚未访问的祖先，深度不超过树高
+typedef struct AVLIterator{
+    AVLNode** stack;
+    int top;
+}AVLIterator;
+
+// 冻结后的只读编号集合：按Eytzinger顺序（完全二叉树的BFS编号）放在连续数组里，
+// keys[1..n]有效，k的孩子是2k和2k+1；数组按缓存行对齐，连续四层的16个后代落在同一行
+typedef struct FrozenIdSet{
+    int* keys;
+    int n;
+    int fullLevels; // 满层数，批量查找时所有查询都先无条件走这么多步
+}FrozenIdSet;
+
 // 全局图变量
 Graph graph;
 int graphCreated = 0;//判断图是否创建完成 
+CSRGraph csr = {0, -1, NULL, NULL, NULL};
+PathCache pathCache = {{NULL}, NULL, NULL, 0, -1, 0, PATH_CACHE_DEFAULT_BUDGET, 0, 0, 0, 0};
+RingQueue levelQueue = {NULL, 0, 0, 0}; // 层次遍历共用的队列
 
 // 函数声明
 void createGraph();
-void addCity(char* name);
-int getCityIndex(char* name);
+int addCity(const char* name);
+int getCityIndex(const char* name);
+const char* cityName(int i); // 获取城市名
+void freeGraph(); // 释放当前地图的全部数据
+void allocMatrix(int n); // 分配邻接矩阵
+int loadGraphFile(const char* path); // 从CSV或DIMACS边表文件加载地图
+void loadGraphMenu(); // 加载路网文件菜单
+void dijkstraHeap(int start, int dist[], int prev[]); // 堆优化Dijkstra（无邻接矩阵时使用）
+PathCacheEntry* getShortestPathTree(int source); // 从缓存取最短路径树，未命中时计算
+void invalidatePathCache(); // 地图修改后使路线缓存失效
+int updateRoad(int src, int dest, int weight); // 修改或删除（weight为INF）一条道路
+void updateRoadMenu(); // 修改/删除道路菜单
+void computeComponents(); // 并行计算所有城市的连通分量编号
+void uniteCities(int a, int b); // 新增道路后合并两个连通分量
+int getComponent(int city); // 查询城市所在连通分量
+void flattenComponents(); // 把所有城市的分量编号压缩为根编号
+int runBatchQueries(const char* data, size_t size, FILE* out); // 多线程批量查询，按输入顺序输出
+int batchQueryFile(const char* inPath, const char* outPath); // 从文件批量查询
+int serveBatchSocket(const char* socketPath); // 在本地套接字上提供批量查询服务
+void batchQueryMenu(); // 批量查询菜单
+int saveSnapshot(const char* path); // 保存地图快照
+int openSnapshot(const char* path); // 映射打开地图快照
+void detachSnapshot(); // 修改前把快照中的数据复制到堆上
+void closeSnapshot(); // 解除快照映射
+void snapshotMenu(); // 保存快照菜单
+void pathCacheMenu(); // 路线缓存统计菜单
 void queryShortestPath();
 void dijkstra(int start, int dist[], int prev[]);
+const char* dijkstraKernel(); // 返回稠密图Dijkstra当前使用的内核名
 void printPath(int prev[], int end);
 void depthFirstSearch();
 void DFS(int start, int visited[]);
 void DFS_collect(int start, int visited[], int path[], int* pathLen);
+void buildCSR(); // 由邻接表构建CSR视图
+CSRGraph* getCSR(); // 获取最新的CSR视图（过期时重建）
+int reachabilityBFS(int start, int level[]); // 方向优化BFS，返回可达城市数
+void reachabilityAnalysis(); // 可达性分析菜单
 void huffmanTree();
-HuffmanNode* createHuffmanNode(char code, int freq);
-HuffmanNode* buildHuffmanTree(char codes[], int freqs[], int n);
+HuffmanNode* buildHuffmanTree(const int symbols[], const long long freqs[], int n, HuffmanNode* pool);
+void huffmanCodeLengths(const HuffmanNode* pool, int n, unsigned char length[], int maxLen); // 由树求码长
+HuffmanCode* buildHuffmanCode(const long long freqs[], int n, int maxLen); // 由频率构建范式赫夫曼编码
+HuffmanCode* huffmanCodeFromLengths(const unsigned char length[], int n); // 由码长恢复范式编码
+int huffmanLengthsValid(const unsigned char length[], int n); // 检查文件中读出的码长
+void freeHuffmanCode(HuffmanCode* hc);
+size_t huffmanEncode(const HuffmanCode* hc, const int symbols[], long long count, unsigned char* out);
+int huffmanDecode(const HuffmanCode* hc, const unsigned char* in, size_t inBytes, int symbols[], long long count);
+int compressQueryLog(const char* inPath, const char* outPath, int maxLen); // 压缩查询日志（每行一个城市名）
+int decompressQueryLog(const char* inPath, const char* outPath); // 解压查询日志
+int streamCompressLog(FILE* in, const char* outPath, double threshold); // 流式压缩，后台自适应换表
+int decompressLogStream(const char* inPath, const char* outPath); // 解压流式压缩的日志
+void queryLogMenu(); // 查询日志压缩菜单
 void levelOrderTraversal_Hu(HuffmanNode* root);
-Queue* createQueue();
-void enqueueHuffman(Queue* q, HuffmanNode* node, char pos);
-QueueNode* dequeue(Queue* q);
-int isQueueEmpty(Queue* q);
+void levelOrderTraverse(const void* root, size_t leftOffset, size_t rightOffset, int widthHint,
+                        LevelVisitor visit, void* ctx); // 通用层次遍历，孩子指针由偏移给出
 void AVLsort();
 AVLNode* createAVLNode(int cityNumber);
 int getHeight(AVLNode* node);
 int getBalanceFactor(AVLNode* node);
+int getSize(AVLNode* node);
+void updateAVLNode(AVLNode* node); // 由孩子重新计算高度和子树大小
 AVLNode* rightright(AVLNode* y);
 AVLNode* leftleft(AVLNode* x);
 AVLNode* AVLinsert(AVLNode* node, int cityNumber);
+AVLNode* AVLdelete(AVLNode* node, int cityNumber); // 删除，不存在时不变
+AVLNode* AVLfind(AVLNode* root, int cityNumber); // 查找
+int AVLrank(AVLNode* root, int cityNumber); // 小于cityNumber的编号个数
+AVLNode* AVLselect(AVLNode* root, int k); // 第k小（从1开始）
+int AVLrangeCount(AVLNode* root, int lo, int hi); // 落在[lo, hi]内的编号个数
+AVLNode* buildAVLFromSorted(const int sorted[], int n); // 由严格升序数组O(n)建平衡树
+void AVLiteratorInit(AVLIterator* it, AVLNode* root);
+AVLNode* AVLiteratorNext(AVLIterator* it); // 按升序返回下一个节点，结束返回NULL
+int freezeSortedIds(const int sorted[], int n, FrozenIdSet* set); // 由严格升序数组构建只读集合
+int freezeAVL(AVLNode* root, FrozenIdSet* set); // 把AVL树冻结成只读集合
+void freeFrozenIdSet(FrozenIdSet* set);
+int frozenContains(const FrozenIdSet* set, int cityNumber);
+void frozenContainsBatch(const FrozenIdSet* set, const int ids[], int count, unsigned char found[]); // 交错批量查找
 void levelOrderTraversal_AVL(AVLNode* root);
-void enqueueAVL(Queue* q, AVLNode* node, char pos);
 void freeAVLTree(AVLNode *root);
 void visualizeMap(); // 地图可视化函数
 AdjListNode* createAdjListNode(int dest, int weight); // 创建邻接表节点
 void addEdgeToAdjList(int src, int dest, int weight); // 添加边到邻接表
 void printAdjList(); // 打印邻接表
+void printComponentSizes(); // 打印连通分量数量和规模
 void showCityList(); // 显示当前已创建的城市列表
 
+// 从节点池分配一个邻接表节点
+static AdjListNode* allocAdjListNode(int blockCap) {
+    NodeBlock* b = graph.nodeBlocks;
+    if (b == NULL || b->used == b->cap) {
+        if (blockCap < 4096) blockCap = 4096;
+        b = (NodeBlock*)malloc(sizeof(NodeBlock) + (size_t)blockCap * sizeof(AdjListNode));
+        b->used = 0;
+        b->cap = blockCap;
+        b->next = graph.nodeBlocks;
+        graph.nodeBlocks = b;
+    }
+    return &b->nodes[b->used++];
+}
+
 // 创建邻接表节点
 AdjListNode* createAdjListNode(int dest, int weight) {
-    AdjListNode* newNode = (AdjListNode*)malloc(sizeof(AdjListNode));
+    AdjListNode* newNode = allocAdjListNode(0);
     newNode->dest = dest;
     newNode->weight = weight;
     newNode->next = NULL;
     return newNode;
 }
 
+// 由CSR展开邻接表（批量加载的地图第一次被修改时调用）
+static void materializeAdjList() {
+    detachSnapshot();
+    int n = graph.numCities;
+    graph.array = (AdjList*)malloc((n > 0 ? n : 1) * sizeof(AdjList));
+    allocAdjListNode(csr.offset[n]);
+    graph.nodeBlocks->used--; // 只为预留一整块，归还刚分配的节点
+    for (int i = 0; i < n; i++) {
+        graph.array[i].head = NULL;
+        // 逆序插入表头，使链表保持邻居编号升序
+        for (int e = csr.offset[i+1] - 1; e >= csr.offset[i]; e--) {
+            AdjListNode* node = createAdjListNode(csr.adj[e], csr.weight[e]);
+            node->next = graph.array[i].head;
+            graph.array[i].head = node;
+        }
+    }
+}
+
 // 添加边到邻接表
 void addEdgeToAdjList(int src, int dest, int weight) {
+    if (graph.array == NULL) materializeAdjList();
     // 添加到src的邻接表
     AdjListNode* newNode = createAdjListNode(dest, weight);
     newNode->next = graph.array[src].head;
@@ -118,21 +434,31 @@ void addEdgeToAdjList(int src, int dest, int weight) {
     newNode = createAdjListNode(src, weight);
     newNode->next = graph.array[dest].head;
     graph.array[dest].head = newNode;
+    graph.version++;
+    uniteCities(src, dest);
 }
 
 // 打印邻接表形式的地图
 void printAdjList() {
+    int n = graph.numCities < PRINT_LIMIT ? graph.numCities : PRINT_LIMIT;
     printf("\n=== 城市交通网络地图（邻接表形式） ===\n");
-    for (int i = 0; i < graph.numCities; i++) {
-        printf("%s -> ", graph.cities[i].name);
+    for (int i = 0; i < n; i++) {
+        printf("%s -> ", cityName(i));
         
-        AdjListNode* temp = graph.array[i].head;
-        while (temp != NULL) {
-            printf("%s(%dkm) -> ", graph.cities[temp->dest].name, temp->weight);
-            temp = temp->next;
+        if (graph.array != NULL) {
+            AdjListNode* temp = graph.array[i].head;
+            while (temp != NULL) {
+                printf("%s(%dkm) -> ", cityName(temp->dest), temp->weight);
+                temp = temp->next;
+            }
+        } else {
+            for (int e = csr.offset[i]; e < csr.offset[i+1]; e++)
+                printf("%s(%dkm) -> ", cityName(csr.adj[e]), csr.weight[e]);
         }
         printf("NULL\n");
     }
+    if (n < graph.numCities)
+        printf("...（共%d个城市，仅显示前%d个）\n", graph.numCities, n);
     printf("======================================\n");
 }
 
@@ -148,16 +474,25 @@ void visualizeMap() {
     // 打印邻接表
     printAdjList();
     
+    printf("城市数: %d，邻接表边数: %d\n", graph.numCities, getCSR()->offset[graph.numCities]);
+    if (graph.matrix != NULL)
+        printf("邻接矩阵Dijkstra内核: %s\n", dijkstraKernel());
+    printComponentSizes();
+    if (graph.matrix == NULL || graph.numCities > PRINT_LIMIT) {
+        printf("===========================\n");
+        return;
+    }
+
     // 打印矩阵形式（可选）
     printf("\n邻接矩阵形式：\n");
     printf("     ");
     for (int i = 0; i < graph.numCities; i++) {
-        printf("%-6.3s ", graph.cities[i].name);
+        printf("%-6.3s ", cityName(i));
     }
     printf("\n");
     
     for (int i = 0; i < graph.numCities; i++) {
-        printf("%-5.3s ", graph.cities[i].name);
+        printf("%-5.3s ", cityName(i));
         for (int j = 0; j < graph.numCities; j++) {
             if (graph.matrix[i][j] == INF) {
                 printf("INF   ");
@@ -172,25 +507,25 @@ void visualizeMap() {
 
 // 创建地图
 void createGraph() {
-    int i, j, n, distance;
+    int i, n = 0, distance = 0;
     char name[MAX_NAME_LENGTH];
 
     printf("\n==============================\n");
     printf("★ 城市交通网络创建 ★\n");
     printf("==============================\n");
     printf("请输入城市数量（最多%d个）: ", MAX_CITIES);
-    scanf("%d", &n);
-    getchar();
+    readerInt(stdinReader(), &n);
+    readerChar(stdinReader());
 
     if (n > MAX_CITIES) {
         printf("城市数量超过上限，自动设置为%d\n", MAX_CITIES);
         n = MAX_CITIES;
     }
 
-    graph.numCities = n;
+    freeGraph();
     
     // 初始化邻接表
-    graph.array = (AdjList*)malloc(n * sizeof(AdjList));
+    graph.array = (AdjList*)malloc((n > 0 ? n : 1) * sizeof(AdjList));
     for (i = 0; i < n; i++) {
         graph.array[i].head = NULL;
     }
@@ -198,30 +533,32 @@ void createGraph() {
     // 初始化城市数组
     for (i = 0; i < n; i++) {
         printf("请输入第%d个城市的拼音: ", i+1);
-        fgets(name, MAX_NAME_LENGTH, stdin);
+        readerLine(stdinReader(), name, MAX_NAME_LENGTH);
         name[strcspn(name, "\n")] = 0; // 移除换行符
-        strcpy(graph.cities[i].name, name);
-        graph.cities[i].index = i;
+        if (getCityIndex(name) != -1) {
+            printf("[错误] 城市%s已存在，请重新输入。\n", name);
+            i--;
+            continue;
+        }
+        addCity(name);
         showCityList();
     }
 
-    // 初始化邻接矩阵
-    for (i = 0; i < n; i++) {
-        for (j = 0; j < n; j++) {
-            if (i == j)
-                graph.matrix[i][j] = 0;
-            else
-                graph.matrix[i][j] = INF;
-        }
-    }
+    // 初始化邻接矩阵和连通分量（每个城市自成一个分量）
+    allocMatrix(n);
+    graph.component = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    for (i = 0; i < n; i++)
+        graph.component[i] = i;
 
     printf("\n请输入城市之间的道路连接距离\n(格式: 城市1 城市2 距离，输入0 0 0结束)：\n");
     showCityList();
     while (1) {
         char name1[MAX_NAME_LENGTH], name2[MAX_NAME_LENGTH];
         printf(">> ");
-        scanf("%s %s %d", name1, name2, &distance);
-        getchar();
+        readerToken(stdinReader(), name1, sizeof(name1));
+        readerToken(stdinReader(), name2, sizeof(name2));
+        readerInt(stdinReader(), &distance);
+        readerChar(stdinReader());
         if (strcmp(name1, "0") == 0 && strcmp(name2, "0") == 0 && distance == 0)
             break;
         int idx1 = getCityIndex(name1);
@@ -241,15 +578,148 @@ void createGraph() {
     visualizeMap();
 }
 
-// 获取城市索引
-int getCityIndex(char* name) {
+// 城市名哈希（FNV-1a）
+static unsigned hashName(const char* name, int len) {
+    unsigned h = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+const char* cityName(int i) {
+    return graph.names + graph.cities[i].nameOffset;
+}
+
+// 释放当前地图的全部数据（城市、名字索引、矩阵、邻接表、CSR）
+void freeGraph() {
+    closeSnapshot();
+    while (graph.nodeBlocks != NULL) {
+        NodeBlock* next = graph.nodeBlocks->next;
+        free(graph.nodeBlocks);
+        graph.nodeBlocks = next;
+    }
+    if (graph.matrix != NULL) free(graph.matrix[0]);
+    free(graph.matrix);
+    free(graph.array);
+    free(graph.cities);
+    free(graph.names);
+    free(graph.nameSlots);
+    free(graph.component);
+    int version = graph.version;
+    memset(&graph, 0, sizeof(graph));
+    graph.version = version + 1;
+    free(csr.offset);
+    free(csr.adj);
+    free(csr.weight);
+    csr.offset = csr.adj = csr.weight = NULL;
+    csr.n = 0;
+    csr.version = -1;
+    graphCreated = 0;
+    invalidatePathCache(); // 缓存项的数组长度与城市数相关，随地图一起释放
+}
+
+// 分配并初始化邻接矩阵（一整块连续内存），城市过多时不分配
+void allocMatrix(int n) {
+    if (n == 0 || n > DENSE_MATRIX_LIMIT) {
+        graph.matrix = NULL;
+        return;
+    }
+    graph.matrix = (int**)malloc(n * sizeof(int*));
+    graph.matrix[0] = (int*)malloc((size_t)n * n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        graph.matrix[i] = graph.matrix[0] + (size_t)i * n;
+        for (int j = 0; j < n; j++)
+            graph.matrix[i][j] = (i == j) ? 0 : INF;
+    }
+}
+
+// 哈希表扩容，按保存的哈希值重新放置；minCap为扩容后的最小槽数
+static void growNameSlots(int minCap) {
+    int newCap = graph.slotCap ? graph.slotCap * 2 : 64;
+    while (newCap < minCap) newCap *= 2;
+    int* slots = (int*)malloc(newCap * sizeof(int));
+    for (int i = 0; i < newCap; i++) slots[i] = -1;
     for (int i = 0; i < graph.numCities; i++) {
-        if (strcmp(graph.cities[i].name, name) == 0)
+        unsigned pos = graph.cities[i].hash & (newCap - 1);
+        while (slots[pos] != -1) pos = (pos + 1) & (newCap - 1);
+        slots[pos] = i;
+    }
+    free(graph.nameSlots);
+    graph.nameSlots = slots;
+    graph.slotCap = newCap;
+}
+
+// 在哈希索引中查找长度为len的城市名（名字不必以'\0'结尾）
+static int findCityN(const char* name, int len, unsigned h) {
+    if (graph.slotCap == 0) return -1;
+    unsigned pos = h & (graph.slotCap - 1);
+    while (graph.nameSlots[pos] != -1) {
+        int i = graph.nameSlots[pos];
+        const char* s = cityName(i);
+        if (graph.cities[i].hash == h && memcmp(s, name, len) == 0 && s[len] == '\0')
             return i;
+        pos = (pos + 1) & (graph.slotCap - 1);
     }
     return -1;
 }
 
+// 添加长度为len的城市名，返回城市编号；已存在则返回原编号
+static int addCityN(const char* name, int len) {
+    unsigned h = hashName(name, len);
+    int idx = findCityN(name, len, h);
+    if (idx != -1) return idx;
+    detachSnapshot();
+
+    if ((graph.numCities + 1) * 2 > graph.slotCap)
+        growNameSlots(0); // 装载因子保持在0.5以下
+    if (graph.numCities == graph.cityCap) {
+        graph.cityCap = graph.cityCap ? graph.cityCap * 2 : MAX_CITIES;
+        graph.cities = (City*)realloc(graph.cities, graph.cityCap * sizeof(City));
+    }
+    if (graph.namesLen + len + 1 > graph.namesCap) {
+        graph.namesCap = graph.namesCap ? graph.namesCap * 2 : 1024;
+        while (graph.namesLen + len + 1 > graph.namesCap) graph.namesCap *= 2;
+        graph.names = (char*)realloc(graph.names, graph.namesCap);
+    }
+
+    idx = graph.numCities++;
+    City* c = &graph.cities[idx];
+    c->nameOffset = graph.namesLen;
+    c->hash = h;
+    c->index = idx;
+    memcpy(graph.names + graph.namesLen, name, len);
+    graph.names[graph.namesLen + len] = '\0';
+    graph.namesLen += len + 1;
+
+    unsigned pos = h & (graph.slotCap - 1);
+    while (graph.nameSlots[pos] != -1) pos = (pos + 1) & (graph.slotCap - 1);
+    graph.nameSlots[pos] = idx;
+    return idx;
+}
+
+// 预先为n个城市分配城市数组和哈希槽，批量加载时避免反复扩容
+static void reserveCities(int n) {
+    if (n > graph.cityCap) {
+        graph.cityCap = n;
+        graph.cities = (City*)realloc(graph.cities, graph.cityCap * sizeof(City));
+    }
+    if (n * 2 > graph.slotCap)
+        growNameSlots(n * 2);
+}
+
+// 添加城市（名字存入名字池并建立索引），返回城市编号；已存在则返回原编号
+int addCity(const char* name) {
+    return addCityN(name, (int)strlen(name));
+}
+
+// 获取城市索引
+int getCityIndex(const char* name) {
+    int len = (int)strlen(name);
+    return findCityN(name, len, hashName(name, len));
+}
+
 // 查询最短路径
 void queryShortestPath() {
     char startName[MAX_NAME_LENGTH], endName[MAX_NAME_LENGTH];
@@ -258,10 +728,10 @@ void queryShortestPath() {
     printf("\n========== 路线查询 =========\n");
     showCityList();
     printf("请输入起始城市: ");
-    fgets(startName, MAX_NAME_LENGTH, stdin);
+    readerLine(stdinReader(), startName, MAX_NAME_LENGTH);
     startName[strcspn(startName, "\n")] = 0;
     printf("请输入目标城市: ");
-    fgets(endName, MAX_NAME_LENGTH, stdin);
+    readerLine(stdinReader(), endName, MAX_NAME_LENGTH);
     endName[strcspn(endName, "\n")] = 0;
 
     start = getCityIndex(startName);
@@ -272,9 +742,15 @@ void queryShortestPath() {
         showCityList();
         return;
     }
+    if (getComponent(start) != getComponent(end)) {
+        // 不在同一连通分量，无需运行Dijkstra
+        printf("城市 %s 和 %s 之间没有路径相连。\n", startName, endName);
+        return;
+    }
 
-    int dist[MAX_CITIES], prev[MAX_CITIES];
-    dijkstra(start, dist, prev);
+    PathCacheEntry* tree = getShortestPathTree(start);
+    int* dist = tree->dist;
+    int* prev = tree->prev;
 
     if (dist[end] == INF) {
         printf("城市 %s 和 %s 之间没有路径相连。\n", startName, endName);
@@ -286,56 +762,606 @@ void queryShortestPath() {
     }
 }
 
+// 稠密图Dijkstra的两个内层循环，按CPU能力选择实现：
+// argmin：key[]中未访问城市为其距离、已访问为INF，返回最小值的最小下标，全为INF时返回-1
+// relax：对未访问（visited[j]==0）且有道路的j，若du+row[j]<dist[j]则更新dist、prev、key；
+// 和超出int范围的（溢出）不算更短，距离不小于INF的城市按不可达处理
+typedef int (*ArgminKernel)(const int key[], int n);
+typedef void (*RelaxKernel)(const int row[], int du, int u, const int visited[],
+                            int dist[], int prev[], int key[], int n);
+
+static int argminScalar(const int key[], int n) {
+    int best = INF, u = -1;
+    for (int j = 0; j < n; j++) {
+        if (key[j] < best) {
+            best = key[j];
+            u = j;
+        }
+    }
+    return u;
+}
+
+static void relaxScalar(const int row[], int du, int u, const int visited[],
+                        int dist[], int prev[], int key[], int n) {
+    for (int j = 0; j < n; j++) {
+        if (!visited[j] && row[j] < INF && (long long)du + row[j] < dist[j]) {
+            dist[j] = key[j] = du + row[j];
+            prev[j] = u;
+        }
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+// AVX2：先求整行最小值，再找第一个等于最小值的位置
+__attribute__((target("avx2")))
+static int argminAVX2(const int key[], int n) {
+    __m256i vmin = _mm256_set1_epi32(INF);
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        vmin = _mm256_min_epi32(vmin, _mm256_loadu_si256((const __m256i*)(key + j)));
+    __m128i m = _mm_min_epi32(_mm256_castsi256_si128(vmin), _mm256_extracti128_si256(vmin, 1));
+    m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    int best = _mm_cvtsi128_si32(m);
+    for (; j < n; j++)
+        if (key[j] < best) best = key[j];
+    if (best == INF) return -1;
+
+    __m256i vbest = _mm256_set1_epi32(best);
+    for (j = 0; j + 8 <= n; j += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(key + j)), vbest);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        if (mask) return j + __builtin_ctz(mask);
+    }
+    for (; key[j] != best; j++) ;
+    return j;
+}
+
+// AVX2：整行做无分支的min-plus松弛，用比较结果作掩码混合写回
+__attribute__((target("avx2")))
+static void relaxAVX2(const int row[], int du, int u, const int visited[],
+                      int dist[], int prev[], int key[], int n) {
+    __m256i vdu = _mm256_set1_epi32(du);
+    __m256i vu = _mm256_set1_epi32(u);
+    __m256i vinf = _mm256_set1_epi32(INF);
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256i r = _mm256_loadu_si256((const __m256i*)(row + j));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dist + j));
+        __m256i vis = _mm256_loadu_si256((const __m256i*)(visited + j));
+        __m256i cand = _mm256_add_epi32(r, vdu);
+        __m256i ok = _mm256_andnot_si256(_mm256_cmpeq_epi32(r, vinf), _mm256_cmpgt_epi32(d, cand));
+        ok = _mm256_andnot_si256(vis, ok);
+        // 有符号加法溢出：和的符号与两个加数都不同
+        __m256i ovf = _mm256_and_si256(_mm256_xor_si256(cand, r), _mm256_xor_si256(cand, vdu));
+        ok = _mm256_andnot_si256(_mm256_srai_epi32(ovf, 31), ok);
+        if (_mm256_testz_si256(ok, ok)) continue;
+        _mm256_storeu_si256((__m256i*)(dist + j), _mm256_blendv_epi8(d, cand, ok));
+        __m256i p = _mm256_loadu_si256((const __m256i*)(prev + j));
+        _mm256_storeu_si256((__m256i*)(prev + j), _mm256_blendv_epi8(p, vu, ok));
+        __m256i k = _mm256_loadu_si256((const __m256i*)(key + j));
+        _mm256_storeu_si256((__m256i*)(key + j), _mm256_blendv_epi8(k, cand, ok));
+    }
+    relaxScalar(row + j, du, u, visited + j, dist + j, prev + j, key + j, n - j);
+}
+
+// AVX-512：尾部用掩码加载，不需要标量收尾
+__attribute__((target("avx512f")))
+static int argminAVX512(const int key[], int n) {
+    __m512i vinf = _mm512_set1_epi32(INF);
+    __m512i vmin = vinf;
+    for (int j = 0; j < n; j += 16) {
+        __mmask16 tail = n - j >= 16 ? 0xFFFF : (__mmask16)((1u << (n - j)) - 1);
+        vmin = _mm512_min_epi32(vmin, _mm512_mask_loadu_epi32(vinf, tail, key + j));
+    }
+    int best = _mm512_reduce_min_epi32(vmin);
+    if (best == INF) return -1;
+    __m512i vbest = _mm512_set1_epi32(best);
+    for (int j = 0; j < n; j += 16) {
+        __mmask16 tail = n - j >= 16 ? 0xFFFF : (__mmask16)((1u << (n - j)) - 1);
+        __mmask16 eq = _mm512_mask_cmpeq_epi32_mask(tail, _mm512_maskz_loadu_epi32(tail, key + j), vbest);
+        if (eq) return j + __builtin_ctz(eq);
+    }
+    return -1;
+}
+
+__attribute__((target("avx512f")))
+static void relaxAVX512(const int row[], int du, int u, const int visited[],
+                        int dist[], int prev[], int key[], int n) {
+    __m512i vdu = _mm512_set1_epi32(du);
+    __m512i vu = _mm512_set1_epi32(u);
+    __m512i vinf = _mm512_set1_epi32(INF);
+    for (int j = 0; j < n; j += 16) {
+        __mmask16 tail = n - j >= 16 ? 0xFFFF : (__mmask16)((1u << (n - j)) - 1);
+        __m512i r = _mm512_mask_loadu_epi32(vinf, tail, row + j);
+        __m512i d = _mm512_maskz_loadu_epi32(tail, dist + j);
+        __m512i cand = _mm512_add_epi32(r, vdu);
+        __mmask16 ok = _mm512_mask_cmpneq_epi32_mask(tail, r, vinf);
+        ok = _mm512_mask_cmpgt_epi32_mask(ok, d, cand);
+        ok = _mm512_mask_cmpeq_epi32_mask(ok, _mm512_maskz_loadu_epi32(tail, visited + j),
+                                          _mm512_setzero_si512());
+        __m512i ovf = _mm512_and_si512(_mm512_xor_si512(cand, r), _mm512_xor_si512(cand, vdu));
+        ok = _mm512_mask_cmpge_epi32_mask(ok, ovf, _mm512_setzero_si512()); // 去掉溢出的
+        if (!ok) continue;
+        _mm512_mask_storeu_epi32(dist + j, ok, cand);
+        _mm512_mask_storeu_epi32(key + j, ok, cand);
+        _mm512_mask_storeu_epi32(prev + j, ok, vu);
+    }
+}
+#endif
+
+static ArgminKernel argminKernel = NULL;
+static RelaxKernel relaxKernel = NULL;
+static const char* dijkstraKernelName = "标量";
+
+// 运行时检测CPU，选择最快的可用内核
+static void selectDijkstraKernels() {
+    argminKernel = argminScalar;
+    relaxKernel = relaxScalar;
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        argminKernel = argminAVX512;
+        relaxKernel = relaxAVX512;
+        dijkstraKernelName = "AVX-512";
+    } else if (__builtin_cpu_supports("avx2")) {
+        argminKernel = argminAVX2;
+        relaxKernel = relaxAVX2;
+        dijkstraKernelName = "AVX2";
+    }
+#endif
+}
+
+const char* dijkstraKernel() {
+    if (argminKernel == NULL) selectDijkstraKernels();
+    return dijkstraKernelName;
+}
+
+// 基于邻接矩阵的Dijkstra，O(V²)，两个内层循环按整行向量化
+// 选点时取距离最小且编号最小的城市，结果与逐个比较的标量版本完全一致
 void dijkstra(int start, int dist[], int prev[]) {
-    int visited[MAX_CITIES] = {0};
-    int i, j, min, u;
+    if (graph.matrix == NULL) {
+        dijkstraHeap(start, dist, prev); // 大图没有邻接矩阵
+        return;
+    }
+    if (argminKernel == NULL) selectDijkstraKernels();
+    STATS_TIMER_BEGIN(timer);
+    int n = graph.numCities;
+    int* visited = (int*)calloc(n, sizeof(int)); // 已访问为-1，便于直接作向量掩码
+    int* key = (int*)malloc(n * sizeof(int));
 
     // 初始化距离和前驱数组
-    for (i = 0; i < graph.numCities; i++) {
-        dist[i] = graph.matrix[start][i];
-        if (dist[i] < INF && i != start) {
-            prev[i] = start;
-        } else {
-            prev[i] = -1;
-        }
+    for (int i = 0; i < n; i++) {
+        dist[i] = key[i] = INF;
+        prev[i] = -1;  // 起始点的前驱为-1
+    }
+    dist[start] = key[start] = 0;
+
+    int settled = 0;
+    for (int i = 0; i < n; i++) {
+        // 找到未访问节点中距离最小的
+        int u = argminKernel(key, n);
+        if (u == -1) break;  // 所有可达节点都已访问
+        visited[u] = -1;
+        key[u] = INF;
+        settled++;
+
+        // 更新相邻节点的距离
+        relaxKernel(graph.matrix[u], dist[u], u, visited, dist, prev, key, n);
     }
+    free(visited);
+    free(key);
+    STATS_ADD(STAT_RELAX, (long long)settled * n); // 每确定一个城市扫描矩阵的一整行
+    STATS_TIMER_END(STAT_DIJKSTRA_DENSE, timer);
+}
+
+// 索引二叉堆：heap[]存城市编号，pos[]记录城市在堆中的位置（-1表示不在堆中）
+static void heapSiftUp(int heap[], int pos[], const int dist[], int i) {
+    int v = heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (dist[heap[parent]] <= dist[v]) break;
+        heap[i] = heap[parent];
+        pos[heap[i]] = i;
+        i = parent;
+    }
+    heap[i] = v;
+    pos[v] = i;
+}
 
-    // 设置起始点
+static void heapSiftDown(int heap[], int pos[], const int dist[], int size, int i) {
+    int v = heap[i];
+    while (2 * i + 1 < size) {
+        int child = 2 * i + 1;
+        if (child + 1 < size && dist[heap[child+1]] < dist[heap[child]]) child++;
+        if (dist[heap[child]] >= dist[v]) break;
+        heap[i] = heap[child];
+        pos[heap[i]] = i;
+        i = child;
+    }
+    heap[i] = v;
+    pos[v] = i;
+}
+
+// 堆优化Dijkstra的主循环，dist/prev/pos需事先初始化为INF/-1/-1
+// target>=0时在确定target的距离后提前结束；touched非NULL时记录被修改过的城市，便于复位
+static void dijkstraRun(const CSRGraph* g, int start, int target, int dist[], int prev[],
+                        int heap[], int pos[], int touched[], int* touchedCount) {
+    STATS_TIMER_BEGIN(timer);
+    long long relaxed = 0, improved = 0, pushes = 1, pops = 0; // 统计先在局部累计
+    int size = 0;
     dist[start] = 0;
-    visited[start] = 1;
-    prev[start] = -1;  // 起始点的前驱为-1
+    heap[size++] = start;
+    pos[start] = 0;
+    if (touched) touched[(*touchedCount)++] = start;
 
-    for (i = 1; i < graph.numCities; i++) {
-        min = INF;
-        u = -1;
-        
-        // 找到未访问节点中距离最小的
-        for (j = 0; j < graph.numCities; j++) {
-            if (!visited[j] && dist[j] < min) {
-                min = dist[j];
-                u = j;
+    while (size > 0) {
+        int u = heap[0];
+        pos[u] = -2; // 已确定最短距离
+        heap[0] = heap[--size];
+        if (size > 0) heapSiftDown(heap, pos, dist, size, 0);
+        pops++;
+        if (u == target) break;
+
+        for (int e = g->offset[u]; e < g->offset[u+1]; e++) {
+            int v = g->adj[e];
+            if (pos[v] == -2) continue;
+            relaxed++;
+            long long nd = (long long)dist[u] + g->weight[e]; // 64位相加，不小于INF的距离按不可达处理
+            if (nd < dist[v]) {
+                if (touched && dist[v] == INF) touched[(*touchedCount)++] = v;
+                dist[v] = (int)nd;
+                prev[v] = u;
+                improved++;
+                if (pos[v] == -1) {
+                    heap[size] = v;
+                    heapSiftUp(heap, pos, dist, size++);
+                    pushes++;
+                } else {
+                    heapSiftUp(heap, pos, dist, pos[v]);
+                }
             }
         }
+    }
+    STATS_ADD(STAT_RELAX, relaxed);
+    STATS_ADD(STAT_IMPROVE, improved);
+    STATS_ADD(STAT_HEAP_PUSH, pushes);
+    STATS_ADD(STAT_HEAP_DECREASE, improved - (pushes - 1));
+    STATS_ADD(STAT_HEAP_POP, pops);
+    STATS_TIMER_END(STAT_DIJKSTRA_HEAP, timer);
+}
 
-        if (u == -1) break;  // 所有可达节点都已访问
-        visited[u] = 1;
+// 堆优化Dijkstra，基于CSR视图，O((V+E)logV)
+void dijkstraHeap(int start, int dist[], int prev[]) {
+    CSRGraph* g = getCSR();
+    int n = g->n;
+    int* heap = (int*)malloc(n * sizeof(int));
+    int* pos = (int*)malloc(n * sizeof(int));
 
-        // 更新相邻节点的距离
-        for (j = 0; j < graph.numCities; j++) {
-            if (!visited[j] && graph.matrix[u][j] < INF) {
-                // 防止整数溢出
-                if (dist[u] < INF && dist[u] + graph.matrix[u][j] < dist[j]) {
-                    dist[j] = dist[u] + graph.matrix[u][j];
-                    prev[j] = u;
+    for (int i = 0; i < n; i++) {
+        dist[i] = INF;
+        prev[i] = -1;
+        pos[i] = -1;
+    }
+    dijkstraRun(g, start, -1, dist, prev, heap, pos, NULL, NULL);
+    free(heap);
+    free(pos);
+}
+
+// 每个缓存项占用的字节数
+static long long pathCacheEntryBytes() {
+    return (long long)sizeof(PathCacheEntry) + 2LL * graph.numCities * sizeof(int);
+}
+
+static void pathCacheUnlink(PathCacheEntry* e) {
+    if (e->lruPrev) e->lruPrev->lruNext = e->lruNext;
+    else pathCache.head = e->lruNext;
+    if (e->lruNext) e->lruNext->lruPrev = e->lruPrev;
+    else pathCache.tail = e->lruPrev;
+}
+
+static void pathCachePushFront(PathCacheEntry* e) {
+    e->lruPrev = NULL;
+    e->lruNext = pathCache.head;
+    if (pathCache.head) pathCache.head->lruPrev = e;
+    pathCache.head = e;
+    if (pathCache.tail == NULL) pathCache.tail = e;
+}
+
+static void freePathCacheEntry(PathCacheEntry* e) {
+    free(e->dist);
+    free(e->prev);
+    free(e);
+}
+
+// 淘汰最久未使用的缓存项
+static void pathCacheEvict() {
+    PathCacheEntry* e = pathCache.tail;
+    PathCacheEntry** p = &pathCache.buckets[e->source % PATH_CACHE_BUCKETS];
+    while (*p != e) p = &(*p)->hashNext;
+    *p = e->hashNext;
+    pathCacheUnlink(e);
+    pathCache.count--;
+    pathCache.bytesUsed -= pathCacheEntryBytes();
+    pathCache.evictions++;
+    freePathCacheEntry(e);
+}
+
+// 地图修改后使路线缓存失效
+void invalidatePathCache() {
+    if (pathCache.count > 0) pathCache.invalidations++;
+    PathCacheEntry* e = pathCache.head;
+    while (e != NULL) {
+        PathCacheEntry* next = e->lruNext;
+        freePathCacheEntry(e);
+        e = next;
+    }
+    memset(pathCache.buckets, 0, sizeof(pathCache.buckets));
+    pathCache.head = pathCache.tail = NULL;
+    pathCache.count = 0;
+    pathCache.bytesUsed = 0;
+    pathCache.version = graph.version;
+}
+
+// 取得以source为起点的最短路径树，数组归缓存所有，调用者不要释放
+// 地图被修改（graph.version变化）后，旧的缓存项全部失效
+// 至少保留最近使用的一项，即使它单独超过内存上限
+PathCacheEntry* getShortestPathTree(int source) {
+    if (pathCache.version != graph.version)
+        invalidatePathCache();
+
+    PathCacheEntry* e = pathCache.buckets[source % PATH_CACHE_BUCKETS];
+    while (e != NULL && e->source != source) e = e->hashNext;
+    if (e != NULL) {
+        pathCache.hits++;
+        pathCacheUnlink(e);
+        pathCachePushFront(e);
+        return e;
+    }
+
+    pathCache.misses++;
+    long long bytes = pathCacheEntryBytes();
+    while (pathCache.count > 0 && pathCache.bytesUsed + bytes > pathCache.budget)
+        pathCacheEvict();
+    e = (PathCacheEntry*)malloc(sizeof(PathCacheEntry));
+    e->source = source;
+    e->dist = (int*)malloc(graph.numCities * sizeof(int));
+    e->prev = (int*)malloc(graph.numCities * sizeof(int));
+    dijkstra(source, e->dist, e->prev);
+    e->hashNext = pathCache.buckets[source % PATH_CACHE_BUCKETS];
+    pathCache.buckets[source % PATH_CACHE_BUCKETS] = e;
+    pathCachePushFront(e);
+    pathCache.count++;
+    pathCache.bytesUsed += bytes;
+    return e;
+}
+
+// 路线缓存统计，可调整缓存上限
+void pathCacheMenu() {
+    long long total = pathCache.hits + pathCache.misses;
+    printf("\n---------- 路线缓存统计 ----------\n");
+    printf("命中: %lld  未命中: %lld  命中率: %.1f%%\n", pathCache.hits, pathCache.misses,
+           total > 0 ? pathCache.hits * 100.0 / total : 0.0);
+    printf("淘汰: %lld  因地图修改失效: %lld\n", pathCache.evictions, pathCache.invalidations);
+    printf("缓存项: %d  占用: %.2f MB / 上限 %.2f MB（每项 %.2f MB）\n", pathCache.count,
+           pathCache.bytesUsed / 1048576.0, pathCache.budget / 1048576.0,
+           pathCacheEntryBytes() / 1048576.0);
+    printf("输入新的缓存上限（MB，0表示不修改）: ");
+    int mb = 0;
+    readerInt(stdinReader(), &mb);
+    readerChar(stdinReader());
+    if (mb > 0) {
+        pathCache.budget = (long long)mb << 20;
+        while (pathCache.count > 1 && pathCache.bytesUsed > pathCache.budget)
+            pathCacheEvict();
+        printf("缓存上限已修改为%d MB\n", mb);
+    }
+}
+
+// 修复最短路径树时使用的二叉堆（允许重复入堆，出堆时跳过过期项）
+typedef struct RepairItem {
+    int dist, city;
+} RepairItem;
+
+typedef struct RepairHeap {
+    RepairItem* items;
+    int size, cap;
+} RepairHeap;
+
+static void repairHeapPush(RepairHeap* h, int dist, int city) {
+    if (h->size == h->cap) {
+        h->cap = h->cap ? h->cap * 2 : 64;
+        h->items = (RepairItem*)realloc(h->items, h->cap * sizeof(RepairItem));
+    }
+    int i = h->size++;
+    while (i > 0 && h->items[(i - 1) / 2].dist > dist) {
+        h->items[i] = h->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->items[i].dist = dist;
+    h->items[i].city = city;
+}
+
+static RepairItem repairHeapPop(RepairHeap* h) {
+    RepairItem top = h->items[0];
+    RepairItem last = h->items[--h->size];
+    int i = 0;
+    while (2 * i + 1 < h->size) {
+        int child = 2 * i + 1;
+        if (child + 1 < h->size && h->items[child+1].dist < h->items[child].dist) child++;
+        if (h->items[child].dist >= last.dist) break;
+        h->items[i] = h->items[child];
+        i = child;
+    }
+    h->items[i] = last;
+    return top;
+}
+
+// 从堆中的城市继续做Dijkstra松弛，只有距离真正变小的城市才会入堆
+static void repairPropagate(RepairHeap* h, int dist[], int prev[]) {
+    while (h->size > 0) {
+        RepairItem it = repairHeapPop(h);
+        if (it.dist != dist[it.city]) continue; // 过期项
+        for (AdjListNode* p = graph.array[it.city].head; p != NULL; p = p->next) {
+            if ((long long)it.dist + p->weight < dist[p->dest]) {
+                dist[p->dest] = it.dist + p->weight;
+                prev[p->dest] = it.city;
+                repairHeapPush(h, dist[p->dest], p->dest);
+            }
+        }
+    }
+}
+
+// 道路u-v变短（或新增）后修复一棵最短路径树
+static void repairDecrease(int dist[], int prev[], int u, int v, int weight, RepairHeap* h) {
+    if (dist[u] == INF || (long long)dist[u] + weight >= dist[v]) return;
+    dist[v] = dist[u] + weight;
+    prev[v] = u;
+    repairHeapPush(h, dist[v], v);
+    repairPropagate(h, dist, prev);
+}
+
+// 树边u->v变长（或删除）后修复一棵最短路径树（Ramalingam-Reps）：
+// 1. 沿树找出v的子树，即最短路径经过该边的城市；
+// 2. 这些城市从子树外的邻居中重新选择前驱；
+// 3. 在子树内部做Dijkstra。子树之外的城市距离不变，不会被访问。
+// 返回受影响的城市数
+static int repairIncrease(int dist[], int prev[], int u, int v, RepairHeap* h) {
+    if (prev[v] != u) return 0; // 不是树边，最短路径不受影响
+    int* affected = (int*)malloc(64 * sizeof(int));
+    int count = 0, cap = 64;
+    affected[count++] = v;
+    for (int i = 0; i < count; i++) {
+        int x = affected[i];
+        for (AdjListNode* p = graph.array[x].head; p != NULL; p = p->next) {
+            if (prev[p->dest] == x) {
+                if (count == cap) {
+                    cap *= 2;
+                    affected = (int*)realloc(affected, cap * sizeof(int));
                 }
+                prev[p->dest] = -1; // 防止平行道路导致重复收集
+                affected[count++] = p->dest;
             }
         }
     }
+    for (int i = 0; i < count; i++) {
+        dist[affected[i]] = INF;
+        prev[affected[i]] = -1;
+    }
+    // 无向图中入边即邻接表中的边，子树外的邻居距离已是最终值
+    for (int i = 0; i < count; i++) {
+        int x = affected[i];
+        for (AdjListNode* p = graph.array[x].head; p != NULL; p = p->next) {
+            int d = dist[p->dest];
+            if (d != INF && (long long)d + p->weight < dist[x]) {
+                dist[x] = d + p->weight;
+                prev[x] = p->dest;
+            }
+        }
+        if (dist[x] != INF) repairHeapPush(h, dist[x], x);
+    }
+    repairPropagate(h, dist, prev);
+    free(affected);
+    return count;
+}
+
+// 从src的邻接表中删除所有通往dest的边，返回其中最短的距离（不存在返回INF）
+static int removeArcs(int src, int dest) {
+    int oldWeight = INF;
+    AdjListNode** p = &graph.array[src].head;
+    while (*p != NULL) {
+        if ((*p)->dest == dest) {
+            if ((*p)->weight < oldWeight) oldWeight = (*p)->weight;
+            *p = (*p)->next; // 节点留在节点池中，随地图一起释放
+        } else {
+            p = &(*p)->next;
+        }
+    }
+    return oldWeight;
+}
+
+// 修改或删除（weight为INF）一条道路，并就地修复缓存中的最短路径树
+// 无向图同时修改两个方向，有向图只修改src->dest；成功返回0，删除不存在的道路返回-1
+int updateRoad(int src, int dest, int weight) {
+    if (src == dest) return -1;
+    if (graph.array == NULL) materializeAdjList();
+    int cacheValid = (pathCache.version == graph.version);
+
+    int oldWeight = removeArcs(src, dest);
+    if (!graph.directed) removeArcs(dest, src);
+    if (oldWeight == INF && weight == INF) return -1;
+    if (weight != INF) {
+        AdjListNode* node = createAdjListNode(dest, weight);
+        node->next = graph.array[src].head;
+        graph.array[src].head = node;
+        if (!graph.directed) {
+            node = createAdjListNode(src, weight);
+            node->next = graph.array[dest].head;
+            graph.array[dest].head = node;
+        }
+    }
+    if (graph.matrix != NULL) {
+        graph.matrix[src][dest] = weight;
+        if (!graph.directed) graph.matrix[dest][src] = weight;
+    }
+    graph.version++;
+    if (weight != INF)
+        uniteCities(src, dest);
+    else
+        graph.componentsDirty = 1;
+    if (!cacheValid) return 0; // 缓存已过期，下次查询时整体失效
+
+    RepairHeap h = {NULL, 0, 0};
+    for (PathCacheEntry* e = pathCache.head; e != NULL; e = e->lruNext) {
+        if (graph.directed) {
+            // 有向图的邻接表没有入边，退化为重新计算
+            dijkstra(e->source, e->dist, e->prev);
+        } else if (weight < oldWeight) {
+            repairDecrease(e->dist, e->prev, src, dest, weight, &h);
+            repairDecrease(e->dist, e->prev, dest, src, weight, &h);
+        } else if (weight > oldWeight) {
+            repairIncrease(e->dist, e->prev, src, dest, &h);
+            repairIncrease(e->dist, e->prev, dest, src, &h);
+        }
+    }
+    free(h.items);
+    pathCache.version = graph.version; // 修复后的最短路径树仍然有效
+    return 0;
+}
+
+// 修改/删除道路菜单
+void updateRoadMenu() {
+    char name1[MAX_NAME_LENGTH], name2[MAX_NAME_LENGTH];
+    int distance = 0;
+    printf("\n---------- 修改/删除道路 ----------\n");
+    showCityList();
+    printf("请输入道路(格式: 城市1 城市2 新距离，距离为-1表示删除): ");
+    readerToken(stdinReader(), name1, sizeof(name1));
+    readerToken(stdinReader(), name2, sizeof(name2));
+    readerInt(stdinReader(), &distance);
+    readerChar(stdinReader());
+    int idx1 = getCityIndex(name1);
+    int idx2 = getCityIndex(name2);
+    if (idx1 == -1 || idx2 == -1) {
+        printf("[错误] 城市不存在！\n");
+        return;
+    }
+    if (updateRoad(idx1, idx2, distance < 0 ? INF : distance) != 0) {
+        printf("[错误] 道路不存在！\n");
+        return;
+    }
+    if (distance < 0)
+        printf("[提示] 已删除道路 %s - %s", name1, name2);
+    else
+        printf("[提示] 道路 %s - %s 的距离已修改为 %d 公里", name1, name2, distance);
+    if (pathCache.version == graph.version && pathCache.count > 0)
+        printf("，已修复%d棵缓存的最短路径树", pathCache.count);
+    printf("\n");
 }
 
 // 打印路径
 void printPath(int prev[], int end) {
-    int path[MAX_CITIES];
+    int* path = (int*)malloc(graph.numCities * sizeof(int));
     int count = 0;
     int current = end;
     
@@ -347,24 +1373,25 @@ void printPath(int prev[], int end) {
     
     // 正向打印路径
     for (int i = count - 1; i >= 0; i--) {
-        printf("%s", graph.cities[path[i]].name);
+        printf("%s", cityName(path[i]));
         if (i > 0) {
             printf(" -> ");
         }
     }
+    free(path);
 }
 
 // 深度优先搜索
 void depthFirstSearch() {
     char startName[MAX_NAME_LENGTH];
     int start;
-    int visited[MAX_CITIES] = {0};
-    int path[MAX_CITIES];
+    int* visited;
+    int* path;
     int pathLen = 0;
     printf("\n---------- 深度优先搜索 ----------\n");
     showCityList();
     printf("请输入起始城市: ");
-    fgets(startName, MAX_NAME_LENGTH, stdin);
+    readerLine(stdinReader(), startName, MAX_NAME_LENGTH);
     startName[strcspn(startName, "\n")] = 0;
 
     start = getCityIndex(startName);
@@ -374,155 +1401,2236 @@ void depthFirstSearch() {
         return;
     }
 
+    visited = (int*)calloc(graph.numCities, sizeof(int));
+    path = (int*)malloc(graph.numCities * sizeof(int));
     DFS_collect(start, visited, path, &pathLen);
     printf("DFS遍历路线: ");
     for (int i = 0; i < pathLen; i++) {
-        printf("%s", graph.cities[path[i]].name);
+        printf("%s", cityName(path[i]));
         if (i < pathLen - 1) printf(" -> ");
     }
     printf("\n城市清单: ");
     for (int i = 0; i < pathLen; i++) {
-        printf("%s", graph.cities[path[i]].name);
+        printf("%s", cityName(path[i]));
         if (i < pathLen - 1) printf(", ");
     }
     printf("\n");
+    free(visited);
+    free(path);
 }
 
-// DFS递归函数
-void DFS(int start, int visited[]) {
-    printf("%s ", graph.cities[start].name);
-    visited[start] = 1;
+typedef struct CSREntry {
+    int adj, weight;
+} CSREntry;
 
-    for (int i = 0; i < graph.numCities; i++) {
-        if (graph.matrix[start][i] != INF && !visited[i]) {
-            DFS(i, visited);
+static int compareCSREntry(const void* a, const void* b) {
+    const CSREntry* x = (const CSREntry*)a;
+    const CSREntry* y = (const CSREntry*)b;
+    return (x->adj > y->adj) - (x->adj < y->adj);
+}
+
+// 按邻居编号升序排列一行（与按矩阵行扫描的顺序一致）
+static void sortCSRRow(int* adj, int* weight, int len) {
+    if (len > 32) {
+        // 高度数城市用qsort，避免插入排序退化为平方复杂度
+        CSREntry* tmp = (CSREntry*)malloc(len * sizeof(CSREntry));
+        for (int i = 0; i < len; i++) {
+            tmp[i].adj = adj[i];
+            tmp[i].weight = weight[i];
+        }
+        qsort(tmp, len, sizeof(CSREntry), compareCSREntry);
+        for (int i = 0; i < len; i++) {
+            adj[i] = tmp[i].adj;
+            weight[i] = tmp[i].weight;
+        }
+        free(tmp);
+        return;
+    }
+    for (int i = 1; i < len; i++) {
+        int a = adj[i], w = weight[i], j = i - 1;
+        while (j >= 0 && adj[j] > a) {
+            adj[j+1] = adj[j];
+            weight[j+1] = weight[j];
+            j--;
         }
+        adj[j+1] = a;
+        weight[j+1] = w;
     }
 }
 
-void DFS_collect(int start, int visited[], int path[], int* pathLen) {
+// 由邻接表构建CSR视图
+void buildCSR() {
+    int n = graph.numCities;
+    free(csr.offset);
+    free(csr.adj);
+    free(csr.weight);
+    csr.n = n;
+    csr.offset = (int*)calloc(n + 1, sizeof(int));
+    for (int i = 0; i < n; i++) {
+        for (AdjListNode* p = graph.array[i].head; p != NULL; p = p->next)
+            csr.offset[i+1]++;
+    }
+    for (int i = 0; i < n; i++)
+        csr.offset[i+1] += csr.offset[i];
+    int m = csr.offset[n];
+    csr.adj = (int*)malloc((m > 0 ? m : 1) * sizeof(int));
+    csr.weight = (int*)malloc((m > 0 ? m : 1) * sizeof(int));
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < n; i++) {
+        int k = csr.offset[i];
+        for (AdjListNode* p = graph.array[i].head; p != NULL; p = p->next) {
+            csr.adj[k] = p->dest;
+            csr.weight[k] = p->weight;
+            k++;
+        }
+        sortCSRRow(csr.adj + csr.offset[i], csr.weight + csr.offset[i], k - csr.offset[i]);
+    }
+    csr.version = graph.version;
+}
+
+// 获取最新的CSR视图（批量加载的地图没有邻接表，CSR本身就是最新数据）
+CSRGraph* getCSR() {
+    if (graph.array != NULL && (csr.version != graph.version || csr.n != graph.numCities))
+        buildCSR();
+    return &csr;
+}
+
+static inline int bitmapTest(const Bitmap* bm, int v) {
+    return (int)((bm[v >> 6] >> (v & 63)) & 1ULL);
+}
+
+static inline void bitmapSet(Bitmap* bm, int v) {
+    bm[v >> 6] |= 1ULL << (v & 63);
+}
+
+// 原子地置位，返回置位前该位是否已为1（多线程扩展前沿时使用）
+static inline int bitmapTestAndSet(Bitmap* bm, int v) {
+    Bitmap mask = 1ULL << (v & 63);
+    if (bm[v >> 6] & mask) return 1;
+    return (__atomic_fetch_or(&bm[v >> 6], mask, __ATOMIC_RELAXED) & mask) != 0;
+}
+
+// 显式栈深度优先遍历，访问顺序与原递归版本一致
+// order为NULL时只标记访问，不记录顺序
+static int DFS_iterative(int start, int visited[], int order[]) {
+    CSRGraph* g = getCSR();
+    int count = 0;
+    int* stack = (int*)malloc(g->n * sizeof(int));   // 当前路径上的城市
+    int* cursor = (int*)malloc(g->n * sizeof(int));  // 每层下一条待检查的边
+    int top = 0;
+
     visited[start] = 1;
-    path[(*pathLen)++] = start;
-    for (int i = 0; i < graph.numCities; i++) {
-        if (graph.matrix[start][i] != INF && !visited[i]) {
-            DFS_collect(i, visited, path, pathLen);
+    if (order) order[count] = start;
+    count++;
+    stack[0] = start;
+    cursor[0] = g->offset[start];
+    while (top >= 0) {
+        int u = stack[top];
+        int e = cursor[top];
+        while (e < g->offset[u+1] && visited[g->adj[e]]) e++;
+        if (e == g->offset[u+1]) {
+            top--; // 所有邻居已访问，回溯
+            continue;
         }
+        int v = g->adj[e];
+        cursor[top] = e + 1;
+        visited[v] = 1;
+        if (order) order[count] = v;
+        count++;
+        top++;
+        stack[top] = v;
+        cursor[top] = g->offset[v];
     }
+    free(stack);
+    free(cursor);
+    return count;
 }
 
-// 创建赫夫曼节点
-HuffmanNode* createHuffmanNode(char code, int freq) {
-    HuffmanNode* node = (HuffmanNode*)malloc(sizeof(HuffmanNode));
-    node->cityCode = code;
-    node->frequency = freq;
-    node->left = node->right = NULL;
-    return node;
+// DFS遍历并打印
+void DFS(int start, int visited[]) {
+    int* order = (int*)malloc(graph.numCities * sizeof(int));
+    int count = DFS_iterative(start, visited, order);
+    for (int i = 0; i < count; i++)
+        printf("%s ", cityName(order[i]));
+    free(order);
 }
 
-// 构建赫夫曼树
-HuffmanNode* buildHuffmanTree(char codes[], int freqs[], int n) {
-    HuffmanNode *nodes[MAX_CITIES];
-    int i, j;
-    for (i = 0; i < n; i++) {
-        nodes[i] = createHuffmanNode(codes[i], freqs[i]);
-    }
-    for (i = 0; i < n-1; i++) {
-        // 找到两个频率最小的节点
-        int min1 = -1, min2 = -1;
-        for (j = 0; j < n; j++) {
-            if (nodes[j] != NULL) {
-                if (min1 == -1 || nodes[j]->frequency < nodes[min1]->frequency) {
-                    min2 = min1;
-                    min1 = j;
-                } else if (min2 == -1 || nodes[j]->frequency < nodes[min2]->frequency) {
-                    min2 = j;
-                }
+void DFS_collect(int start, int visited[], int path[], int* pathLen) {
+    *pathLen += DFS_iterative(start, visited, path + *pathLen);
+}
+
+// 方向优化BFS的切换参数（Beamer等人推荐值）
+#define BFS_ALPHA 14
+#define BFS_BETA 24
+
+// 自顶向下：从前沿出发扩展未访问邻居
+static int bfsTopDown(CSRGraph* g, const int* frontier, int frontierSize,
+                      int* next, Bitmap* visited, int level[], int depth) {
+    int nextSize = 0;
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < frontierSize; i++) {
+        int u = frontier[i];
+        for (int e = g->offset[u]; e < g->offset[u+1]; e++) {
+            int v = g->adj[e];
+            if (!bitmapTestAndSet(visited, v)) {
+                if (level) level[v] = depth;
+                next[__atomic_fetch_add(&nextSize, 1, __ATOMIC_RELAXED)] = v;
             }
         }
-        // 创建新节点
-        HuffmanNode* newNode = createHuffmanNode('\0', nodes[min1]->frequency + nodes[min2]->frequency);
-        newNode->left = nodes[min1];
-        newNode->right = nodes[min2];
-        nodes[min1] = newNode;
-        nodes[min2] = NULL;
     }
-    for (i = 0; i < n; i++) {
-        if (nodes[i] != NULL) {
-            return nodes[i];
+    return nextSize;
+}
+
+// 有向图的入弧表：rev中城市v的邻居是所有有弧指向v的城市（计数排序，O(V+E)）
+static void buildReverseCSR(const CSRGraph* g, CSRGraph* rev) {
+    int n = g->n, m = g->offset[n];
+    rev->n = n;
+    rev->version = g->version;
+    rev->offset = (int*)calloc(n + 1, sizeof(int));
+    rev->adj = (int*)malloc((m > 0 ? m : 1) * sizeof(int));
+    rev->weight = NULL;
+    for (int e = 0; e < m; e++) rev->offset[g->adj[e] + 1]++;
+    for (int i = 0; i < n; i++) rev->offset[i + 1] += rev->offset[i];
+    int* pos = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    memcpy(pos, rev->offset, n * sizeof(int));
+    for (int u = 0; u < n; u++)
+        for (int e = g->offset[u]; e < g->offset[u+1]; e++)
+            rev->adj[pos[g->adj[e]]++] = u;
+    free(pos);
+}
+
+// 自底向上：每个未访问城市检查是否有邻居位于前沿（g须是入弧表，无向图即自身）
+static int bfsBottomUp(CSRGraph* g, const Bitmap* frontier, Bitmap* next,
+                       Bitmap* visited, int level[], int depth) {
+    int words = BITMAP_WORDS(g->n);
+    int nextSize = 0;
+    memset(next, 0, words * sizeof(Bitmap));
+    #pragma omp parallel for schedule(dynamic, 16) reduction(+:nextSize)
+    for (int w = 0; w < words; w++) {
+        Bitmap unvisited = ~visited[w];
+        Bitmap found = 0;
+        while (unvisited) {
+            int v = w * 64 + __builtin_ctzll(unvisited);
+            unvisited &= unvisited - 1;
+            if (v >= g->n) break;
+            for (int e = g->offset[v]; e < g->offset[v+1]; e++) {
+                if (bitmapTest(frontier, g->adj[e])) {
+                    found |= 1ULL << (v & 63);
+                    if (level) level[v] = depth;
+                    nextSize++;
+                    break;
+                }
+            }
         }
+        next[w] = found; // 每个线程只写自己负责的字，无需原子操作
     }
-    return NULL;
+    for (int w = 0; w < words; w++)
+        visited[w] |= next[w];
+    return nextSize;
 }
 
-// 构建赫夫曼树
-void huffmanTree() {
-    int n, i;
-    char codes[MAX_CITIES];
-    int freqs[MAX_CITIES];
-    printf("请输入城市数量（最多20个）: ");
-    scanf("%d", &n);
-    getchar();
-    if (n > MAX_CITIES) {
-        printf("数量超过上限，自动设置为%d\n", MAX_CITIES);
-        n = MAX_CITIES;
+// 方向优化BFS（自顶向下/自底向上自动切换），返回可达城市数
+// level非NULL时写入各城市的层数，不可达为-1。有向图自底向上时要看入弧，另建一份入弧表
+int reachabilityBFS(int start, int level[]) {
+    CSRGraph* g = getCSR();
+    CSRGraph rev;
+    CSRGraph* in = g;
+    if (graph.directed) {
+        buildReverseCSR(g, &rev);
+        in = &rev;
     }
-    for (i = 0; i < n; i++) {
-        printf("请输入第%d个城市的编码（单个字母）: ", i+1);
-        scanf("%c", &codes[i]);
-        getchar();
+    int n = g->n;
+    int words = BITMAP_WORDS(n);
+    Bitmap* visited = (Bitmap*)calloc(words, sizeof(Bitmap));
+    Bitmap* frontierBits = (Bitmap*)calloc(words, sizeof(Bitmap));
+    Bitmap* nextBits = (Bitmap*)calloc(words, sizeof(Bitmap));
+    int* frontier = (int*)malloc(n * sizeof(int));
+    int* next = (int*)malloc(n * sizeof(int));
+    long long edgesToCheck = g->offset[n]; // 未访问城市的度数之和
+    int frontierSize = 1, reached = 1, depth = 0;
+    int bottomUp = 0;
+
+    if (level) {
+        for (int i = 0; i < n; i++) level[i] = -1;
+        level[start] = 0;
+    }
+    bitmapSet(visited, start);
+    frontier[0] = start;
+    edgesToCheck -= g->offset[start+1] - g->offset[start];
+
+    while (frontierSize > 0) {
+        depth++;
+        if (!bottomUp) {
+            long long frontierEdges = 0;
+            for (int i = 0; i < frontierSize; i++)
+                frontierEdges += g->offset[frontier[i]+1] - g->offset[frontier[i]];
+            if (frontierEdges > edgesToCheck / BFS_ALPHA) {
+                // 前沿变大，切换为自底向上
+                memset(frontierBits, 0, words * sizeof(Bitmap));
+                for (int i = 0; i < frontierSize; i++)
+                    bitmapSet(frontierBits, frontier[i]);
+                bottomUp = 1;
+            }
+        } else if (frontierSize < n / BFS_BETA) {
+            // 前沿变小，切换回自顶向下
+            int k = 0;
+            for (int w = 0; w < words; w++) {
+                Bitmap bits = frontierBits[w];
+                while (bits) {
+                    frontier[k++] = w * 64 + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                }
+            }
+            bottomUp = 0;
+        }
+
+        if (bottomUp) {
+            frontierSize = bfsBottomUp(in, frontierBits, nextBits, visited, level, depth);
+            Bitmap* t = frontierBits; frontierBits = nextBits; nextBits = t;
+            for (int w = 0; w < words; w++) {
+                Bitmap bits = frontierBits[w];
+                while (bits) {
+                    int v = w * 64 + __builtin_ctzll(bits);
+                    edgesToCheck -= g->offset[v+1] - g->offset[v];
+                    bits &= bits - 1;
+                }
+            }
+        } else {
+            frontierSize = bfsTopDown(g, frontier, frontierSize, next, visited, level, depth);
+            int* t = frontier; frontier = next; next = t;
+            for (int i = 0; i < frontierSize; i++)
+                edgesToCheck -= g->offset[frontier[i]+1] - g->offset[frontier[i]];
+        }
+        reached += frontierSize;
+    }
+
+    free(visited);
+    free(frontierBits);
+    free(nextBits);
+    free(frontier);
+    free(next);
+    if (in != g) {
+        free(rev.offset);
+        free(rev.adj);
+    }
+    return reached;
+}
+
+// 可达性分析：统计从某城市出发可到达的城市及其换乘层数
+void reachabilityAnalysis() {
+    char startName[MAX_NAME_LENGTH];
+    printf("\n---------- 可达性分析（BFS） ----------\n");
+    showCityList();
+    printf("请输入起始城市: ");
+    readerLine(stdinReader(), startName, MAX_NAME_LENGTH);
+    startName[strcspn(startName, "\n")] = 0;
+
+    int start = getCityIndex(startName);
+    if (start == -1) {
+        printf("[错误] 城市不存在！\n");
+        showCityList();
+        return;
+    }
+
+    int* level = (int*)malloc(graph.numCities * sizeof(int));
+    clock_t t0 = clock();
+    int reached = reachabilityBFS(start, level);
+    double ms = (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC;
+
+    int maxLevel = 0;
+    for (int i = 0; i < graph.numCities; i++)
+        if (level[i] > maxLevel) maxLevel = level[i];
+    int* levelCount = (int*)calloc(maxLevel + 1, sizeof(int));
+    for (int i = 0; i < graph.numCities; i++)
+        if (level[i] >= 0) levelCount[level[i]]++;
+    for (int d = 0; d <= maxLevel; d++) {
+        printf("第%d层(%d个城市)", d, levelCount[d]);
+        if (graph.numCities <= PRINT_LIMIT) {
+            printf(": ");
+            for (int i = 0; i < graph.numCities; i++)
+                if (level[i] == d) printf("%s ", cityName(i));
+        }
+        printf("\n");
+    }
+    free(levelCount);
+    printf("可达城市数: %d / %d，用时 %.3f ms\n", reached, graph.numCities, ms);
+    free(level);
+}
+
+// 并查集查找根节点（路径减半）；并行阶段用原子读写，写入的总是祖先，因而是安全的
+static int findRoot(int* parent, int x) {
+    int p = __atomic_load_n(&parent[x], __ATOMIC_RELAXED);
+    while (p != x) {
+        int gp = __atomic_load_n(&parent[p], __ATOMIC_RELAXED);
+        if (gp != p) __atomic_store_n(&parent[x], gp, __ATOMIC_RELAXED); // 已压缩时不写，快照映射只读
+        x = p;
+        p = gp;
+    }
+    return x;
+}
+
+// 合并a、b所在分量：总是把编号大的根挂到编号小的根下，用CAS保证并行时不丢失合并
+static void uniteRoots(int* parent, int a, int b) {
+    while (1) {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a == b) return;
+        int hi = a > b ? a : b;
+        int lo = a > b ? b : a;
+        int expected = hi;
+        if (__atomic_compare_exchange_n(&parent[hi], &expected, lo, 0,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return;
+    }
+}
+
+// 并行计算所有城市的连通分量编号（有向图按弱连通计算），O(E·α(V))
+void computeComponents() {
+    detachSnapshot();
+    CSRGraph* g = getCSR();
+    int n = g->n;
+    free(graph.component);
+    graph.component = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    int* parent = graph.component;
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++)
+        parent[i] = i;
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int u = 0; u < n; u++) {
+        for (int e = g->offset[u]; e < g->offset[u+1]; e++)
+            if (g->adj[e] < u) uniteRoots(parent, u, g->adj[e]); // 每条无向道路只处理一次
+    }
+    if (graph.directed) {
+        // 有向弧可能只出现一个方向，补上另一方向的合并
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int u = 0; u < n; u++) {
+            for (int e = g->offset[u]; e < g->offset[u+1]; e++)
+                if (g->adj[e] > u) uniteRoots(parent, u, g->adj[e]);
+        }
+    }
+    // 压缩为根编号，之后查询是O(1)
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++)
+        parent[i] = findRoot(parent, i);
+    graph.componentsDirty = 0;
+}
+
+// 新增道路后合并两个连通分量
+void uniteCities(int a, int b) {
+    if (graph.component == NULL || graph.componentsDirty) return; // 下次查询时整体重算
+    uniteRoots(graph.component, a, b);
+}
+
+// 查询城市所在连通分量（删除过道路时先重新计算）
+int getComponent(int city) {
+    if (graph.component == NULL || graph.componentsDirty)
+        computeComponents();
+    if (graph.snapshot != NULL) return graph.component[city]; // 映射只读，打开时已校验编号都是根
+    return findRoot(graph.component, city);
+}
+
+// 把所有城市的分量编号压缩为根编号，之后graph.component[i]可以直接比较。
+// 新增道路后uniteCities只把根挂到根下，其他城市的编号仍指向旧根，保存快照和并行批量查询之前要先调用
+void flattenComponents() {
+    if (graph.component == NULL || graph.componentsDirty) {
+        computeComponents(); // 算完已是压缩的
+        return;
+    }
+    if (graph.snapshot != NULL) return; // 快照中的编号打开时已校验过
+    int* parent = graph.component;
+    for (int i = 0; i < graph.numCities; i++)
+        parent[i] = findRoot(parent, i);
+}
+
+// 打印连通分量数量和规模（按规模从大到小，最多显示10个）
+void printComponentSizes() {
+    int n = graph.numCities;
+    int* size = (int*)calloc(n > 0 ? n : 1, sizeof(int));
+    int count = 0;
+    for (int i = 0; i < n; i++)
+        if (size[getComponent(i)]++ == 0) count++;
+    int top[10], shown = 0;
+    for (int k = 0; k < 10 && k < count; k++) {
+        int best = -1;
+        for (int i = 0; i < n; i++)
+            if (size[i] > 0 && (best == -1 || size[i] > size[best])) best = i;
+        top[shown++] = size[best];
+        size[best] = 0;
+    }
+    printf("连通分量: %d个，规模: ", count);
+    for (int k = 0; k < shown; k++)
+        printf("%d%s", top[k], k < shown - 1 ? ", " : "");
+    if (shown < count) printf(" ...");
+    printf("\n");
+    free(size);
+}
+
+// 只读映射整个文件，返回文件内容起始地址，失败返回NULL
+static const char* mapFile(const char* path, size_t* size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+    LARGE_INTEGER len;
+    GetFileSizeEx(file, &len);
+    *size = (size_t)len.QuadPart;
+    if (*size == 0) {
+        CloseHandle(file);
+        return "";
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const char* data = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (mapping) CloseHandle(mapping); // 视图会保持映射有效
+    CloseHandle(file);
+    return data;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+    if (*size == 0) {
+        close(fd);
+        return "";
+    }
+    void* data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+#ifdef MADV_SEQUENTIAL // 与fastreader.h相同：严格标准模式下没有madvise，省掉预读提示
+    madvise(data, *size, MADV_SEQUENTIAL);
+#endif
+    return (const char*)data;
+#endif
+}
+
+static void unmapFile(const char* data, size_t size) {
+    if (size == 0) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
+// 加载过程中暂存的边表（有向弧）
+typedef struct EdgeBuffer {
+    int *src, *dst, *weight;
+    int count, cap;
+} EdgeBuffer;
+
+static void pushEdge(EdgeBuffer* eb, int src, int dst, int weight) {
+    if (eb->count == eb->cap) {
+        eb->cap = eb->cap ? eb->cap * 2 : 1024;
+        eb->src = (int*)realloc(eb->src, eb->cap * sizeof(int));
+        eb->dst = (int*)realloc(eb->dst, eb->cap * sizeof(int));
+        eb->weight = (int*)realloc(eb->weight, eb->cap * sizeof(int));
+    }
+    eb->src[eb->count] = src;
+    eb->dst[eb->count] = dst;
+    eb->weight[eb->count] = weight;
+    eb->count++;
+}
+
+// 零拷贝扫描：直接在映射的文件内容上移动指针，不复制整行
+static const char* skipLine(const char* p, const char* end) {
+    const char* nl = (const char*)memchr(p, '\n', end - p);
+    return nl ? nl + 1 : end;
+}
+
+static const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+// 解析非负整数，失败返回NULL
+static const char* parseInt(const char* p, const char* end, int* out) {
+    p = skipBlanks(p, end);
+    if (p == end || *p < '0' || *p > '9') return NULL;
+    long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p++ - '0');
+        if (v > INT_MAX) return NULL;
+    }
+    *out = (int)v;
+    return p;
+}
+
+// 取一个以sep或行尾结束的字段（去掉首尾空白），返回字段后的位置
+static const char* parseField(const char* p, const char* end, char sep,
+                              const char** field, int* len) {
+    p = skipBlanks(p, end);
+    const char* start = p;
+    while (p < end && *p != sep && *p != '\n') p++;
+    const char* stop = p;
+    while (stop > start && (stop[-1] == ' ' || stop[-1] == '\t' || stop[-1] == '\r')) stop--;
+    *field = start;
+    *len = (int)(stop - start);
+    if (p < end && *p == sep) p++;
+    return p;
+}
+
+// DIMACS .gr格式：c注释行，p sp n m，a u v w（有向弧，城市编号从1开始）
+// 缺少p行返回-1，p行出现多次返回-2（边表已按第一行分配，不能再换一套大小）
+static int parseDIMACS(const char* p, const char* end, EdgeBuffer* eb, int* skipped) {
+    int n = -1;
+    while (p < end) {
+        if (*p == 'p') {
+            int m;
+            if (n >= 0) return -2;
+            const char* q = p + 1;
+            q = skipBlanks(q, end);
+            while (q < end && *q >= 'a' && *q <= 'z') q++; // 跳过"sp"
+            q = parseInt(q, end, &n);
+            if (q == NULL || parseInt(q, end, &m) == NULL) return -1;
+            eb->cap = m;
+            eb->src = (int*)malloc((m > 0 ? m : 1) * sizeof(int));
+            eb->dst = (int*)malloc((m > 0 ? m : 1) * sizeof(int));
+            eb->weight = (int*)malloc((m > 0 ? m : 1) * sizeof(int));
+            // 城市以编号命名，按顺序建立名字索引
+            char name[16];
+            reserveCities(n);
+            for (int i = 1; i <= n; i++)
+                addCityN(name, snprintf(name, sizeof(name), "%d", i));
+        } else if (*p == 'a') {
+            int u, v, w;
+            const char* q = parseInt(p + 1, end, &u);
+            if (q) q = parseInt(q, end, &v);
+            if (q) q = parseInt(q, end, &w);
+            if (q == NULL || n < 0 || u < 1 || u > n || v < 1 || v > n)
+                (*skipped)++;
+            else
+                pushEdge(eb, u - 1, v - 1, w);
+        }
+        p = skipLine(p, end);
+    }
+    return n < 0 ? -1 : 0;
+}
+
+// CSV格式：每行"城市1,城市2,距离"（无向道路），#开头为注释，无法解析的行（如表头）跳过
+static void parseCSV(const char* p, const char* end, EdgeBuffer* eb, int* skipped) {
+    while (p < end) {
+        const char *name1, *name2;
+        int len1, len2, w;
+        const char* line = skipBlanks(p, end);
+        if (line == end || *line == '\n' || *line == '#') {
+            p = skipLine(line, end);
+            continue;
+        }
+        const char* q = parseField(line, end, ',', &name1, &len1);
+        q = parseField(q, end, ',', &name2, &len2);
+        q = parseInt(q, end, &w);
+        if (q == NULL || len1 == 0 || len2 == 0) {
+            (*skipped)++;
+        } else {
+            int u = addCityN(name1, len1);
+            int v = addCityN(name2, len2);
+            pushEdge(eb, u, v, w);
+            pushEdge(eb, v, u, w);
+        }
+        p = skipLine(q ? q : line, end);
+    }
+}
+
+// 由边表直接构建CSR（计数排序），城市数不超过DENSE_MATRIX_LIMIT时同时填充邻接矩阵
+static void buildGraphFromEdges(EdgeBuffer* eb) {
+    int n = graph.numCities;
+    csr.n = n;
+    csr.offset = (int*)calloc(n + 1, sizeof(int));
+    csr.adj = (int*)malloc((eb->count > 0 ? eb->count : 1) * sizeof(int));
+    csr.weight = (int*)malloc((eb->count > 0 ? eb->count : 1) * sizeof(int));
+    for (int i = 0; i < eb->count; i++)
+        csr.offset[eb->src[i] + 1]++;
+    for (int i = 0; i < n; i++)
+        csr.offset[i+1] += csr.offset[i];
+    int* fill = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    memcpy(fill, csr.offset, n * sizeof(int));
+    for (int i = 0; i < eb->count; i++) {
+        int k = fill[eb->src[i]]++;
+        csr.adj[k] = eb->dst[i];
+        csr.weight[k] = eb->weight[i];
+    }
+    free(fill);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < n; i++)
+        sortCSRRow(csr.adj + csr.offset[i], csr.weight + csr.offset[i], csr.offset[i+1] - csr.offset[i]);
+    csr.version = graph.version;
+
+    allocMatrix(n);
+    if (graph.matrix != NULL) {
+        // 重复的道路取最短的一条，忽略自环
+        for (int i = 0; i < eb->count; i++) {
+            int* cell = &graph.matrix[eb->src[i]][eb->dst[i]];
+            if (eb->src[i] != eb->dst[i] && eb->weight[i] < *cell)
+                *cell = eb->weight[i];
+        }
+    }
+}
+
+// 从CSV或DIMACS .gr边表文件加载地图（也可以是saveSnapshot保存的快照），成功返回0
+int loadGraphFile(const char* path) {
+    size_t size;
+    const char* data = mapFile(path, &size);
+    if (data == NULL) {
+        printf("[错误] 无法打开文件 %s\n", path);
+        return -1;
+    }
+    if (size >= sizeof(SnapshotHeader) && memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0) {
+        unmapFile(data, size);
+        return openSnapshot(path);
+    }
+
+    clock_t t0 = clock();
+    freeGraph();
+    EdgeBuffer eb = {NULL, NULL, NULL, 0, 0};
+    int skipped = 0;
+    const char* end = data + size;
+    const char* first = skipBlanks(data, end);
+    size_t pathLen = strlen(path);
+    int isDIMACS = (pathLen > 3 && strcmp(path + pathLen - 3, ".gr") == 0) ||
+                   (first < end && (*first == 'c' || *first == 'p') &&
+                    first + 1 < end && (first[1] == ' ' || first[1] == '\n'));
+    if (isDIMACS) {
+        int rc = parseDIMACS(data, end, &eb, &skipped);
+        if (rc != 0) {
+            if (rc == -2) printf("[错误] DIMACS文件有多个\"p sp n m\"行\n");
+            else printf("[错误] DIMACS文件缺少\"p sp n m\"行\n");
+            unmapFile(data, size);
+            free(eb.src);
+            free(eb.dst);
+            free(eb.weight);
+            freeGraph();
+            return -1;
+        }
+    } else {
+        parseCSV(data, end, &eb, &skipped);
+    }
+    buildGraphFromEdges(&eb);
+    graph.array = NULL; // 邻接表在第一次修改时再由CSR展开
+    graph.directed = isDIMACS;
+    computeComponents();
+    graphCreated = 1;
+    unmapFile(data, size);
+    free(eb.src);
+    free(eb.dst);
+    free(eb.weight);
+
+    double ms = (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC;
+    printf("[提示] 已加载%s文件: %d个城市, %d条有向弧", isDIMACS ? "DIMACS" : "CSV",
+           graph.numCities, csr.offset[graph.numCities]);
+    if (skipped > 0) printf(", 跳过%d行", skipped);
+    printf(", 用时 %.1f ms (%.1f MB/s)\n", ms, ms > 0 ? size / 1048576.0 / (ms / 1000.0) : 0.0);
+    if (graph.matrix == NULL)
+        printf("[提示] 城市数超过%d，未分配邻接矩阵，最短路径使用堆优化Dijkstra\n", DENSE_MATRIX_LIMIT);
+    return 0;
+}
+
+// 加载路网文件菜单
+void loadGraphMenu() {
+    char path[260];
+    printf("\n---------- 加载路网文件 ----------\n");
+    printf("支持CSV（城市1,城市2,距离）、DIMACS .gr格式和地图快照\n");
+    printf("请输入文件路径: ");
+    readerLine(stdinReader(), path, sizeof(path));
+    path[strcspn(path, "\n")] = 0;
+    if (loadGraphFile(path) == 0 && graph.numCities <= PRINT_LIMIT)
+        visualizeMap();
+}
+
+static void initQueryScratch(QueryScratch* s, int n) {
+    s->dist = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    s->prev = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    s->heap = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    s->pos = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    s->touched = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    s->path = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    s->touchedCount = 0;
+    for (int i = 0; i < n; i++) {
+        s->dist[i] = INF;
+        s->prev[i] = -1;
+        s->pos[i] = -1;
+    }
+}
+
+static void freeQueryScratch(QueryScratch* s) {
+    free(s->dist);
+    free(s->prev);
+    free(s->heap);
+    free(s->pos);
+    free(s->touched);
+    free(s->path);
+}
+
+// 回答一条查询并把结果格式化为"起点,终点,距离,路径"
+// 距离为-1表示没有路径，-2表示城市不存在；路径中城市以'>'分隔
+static void answerBatchQuery(const CSRGraph* g, BatchQuery* q, QueryScratch* s) {
+    int start = findCityN(q->from, q->fromLen, hashName(q->from, q->fromLen));
+    int end = findCityN(q->to, q->toLen, hashName(q->to, q->toLen));
+    int distance = -2, count = 0;
+    size_t len = q->fromLen + q->toLen + 16;
+
+    if (start != -1 && end != -1) {
+        distance = -1;
+        if (graph.component[start] == graph.component[end]) {
+            dijkstraRun(g, start, end, s->dist, s->prev, s->heap, s->pos,
+                        s->touched, &s->touchedCount);
+            if (s->dist[end] != INF) {
+                distance = s->dist[end];
+                for (int c = end; c != -1; c = s->prev[c]) {
+                    s->path[count++] = c;
+                    len += strlen(cityName(c)) + 1;
+                }
+            }
+            for (int i = 0; i < s->touchedCount; i++) {
+                int c = s->touched[i];
+                s->dist[c] = INF;
+                s->prev[c] = -1;
+                s->pos[c] = -1;
+            }
+            s->touchedCount = 0;
+        }
+    }
+
+    q->result = (char*)malloc(len);
+    int k = snprintf(q->result, len, "%.*s,%.*s,%d,", q->fromLen, q->from, q->toLen, q->to, distance);
+    for (int i = count - 1; i >= 0; i--) {
+        const char* name = cityName(s->path[i]);
+        size_t nameLen = strlen(name);
+        memcpy(q->result + k, name, nameLen);
+        k += (int)nameLen;
+        if (i > 0) q->result[k++] = '>';
+    }
+    q->result[k++] = '\n';
+    q->resultLen = k;
+}
+
+// 解析一行查询"城市1,城市2"或"城市1 城市2"，成功返回1
+static int parseQueryLine(const char* line, const char* end, BatchQuery* q) {
+    const char* nl = (const char*)memchr(line, '\n', end - line);
+    const char* stop = nl ? nl : end;
+    if (memchr(line, ',', stop - line) != NULL) {
+        const char* p = parseField(line, stop, ',', &q->from, &q->fromLen);
+        parseField(p, stop, ',', &q->to, &q->toLen);
+    } else {
+        const char* p = skipBlanks(line, stop);
+        q->from = p;
+        while (p < stop && *p != ' ' && *p != '\t' && *p != '\r') p++;
+        q->fromLen = (int)(p - q->from);
+        p = skipBlanks(p, stop);
+        q->to = p;
+        while (p < stop && *p != ' ' && *p != '\t' && *p != '\r') p++;
+        q->toLen = (int)(p - q->to);
+    }
+    return q->fromLen > 0 && q->toLen > 0;
+}
+
+// 多线程批量查询：各线程共享只读的地图，独占自己的工作区，结果按输入顺序写出
+// 返回查询条数
+int runBatchQueries(const char* data, size_t size, FILE* out) {
+    const char* end = data + size;
+    int count = 0, cap = 1024;
+    BatchQuery* queries = (BatchQuery*)malloc(cap * sizeof(BatchQuery));
+    for (const char* p = data; p < end; p = skipLine(p, end)) {
+        const char* line = skipBlanks(p, end);
+        if (line == end || *line == '\n' || *line == '#') continue;
+        if (count == cap) {
+            cap *= 2;
+            queries = (BatchQuery*)realloc(queries, cap * sizeof(BatchQuery));
+        }
+        if (parseQueryLine(line, end, &queries[count])) count++;
+    }
+
+    // 并行区之前准备好所有共享结构，之后只读
+    const CSRGraph* g = getCSR();
+    flattenComponents(); // 工作线程直接比较编号，新增道路后的编号要先全部压缩为根
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+    double t0 = omp_get_wtime();
+#else
+    clock_t t0 = clock();
+#endif
+
+    #pragma omp parallel
+    {
+        QueryScratch scratch;
+        initQueryScratch(&scratch, g->n);
+        #pragma omp for schedule(dynamic, 16)
+        for (int i = 0; i < count; i++)
+            answerBatchQuery(g, &queries[i], &scratch);
+        freeQueryScratch(&scratch);
+    }
+
+#ifdef _OPENMP
+    double ms = (omp_get_wtime() - t0) * 1000.0;
+#else
+    double ms = (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC;
+#endif
+    for (int i = 0; i < count; i++) {
+        fwrite(queries[i].result, 1, queries[i].resultLen, out);
+        free(queries[i].result);
+    }
+    fflush(out);
+    free(queries);
+    fprintf(stderr, "[提示] 批量查询%d条，%d个线程，用时 %.1f ms（%.0f 条/秒）\n",
+            count, threads, ms, ms > 0 ? count / (ms / 1000.0) : 0.0);
+    return count;
+}
+
+// 从文件批量查询，outPath为NULL时输出到标准输出；成功返回0
+int batchQueryFile(const char* inPath, const char* outPath) {
+    size_t size;
+    const char* data = mapFile(inPath, &size);
+    if (data == NULL) {
+        printf("[错误] 无法打开文件 %s\n", inPath);
+        return -1;
+    }
+    FILE* out = outPath ? fopen(outPath, "w") : stdout;
+    if (out == NULL) {
+        printf("[错误] 无法写入文件 %s\n", outPath);
+        unmapFile(data, size);
+        return -1;
+    }
+    runBatchQueries(data, size, out);
+    if (outPath) fclose(out);
+    unmapFile(data, size);
+    return 0;
+}
+
+// 在本地（Unix域）套接字上提供批量查询服务：
+// 客户端连接后写入查询行并关闭写端，服务端按相同顺序写回结果后关闭连接
+int serveBatchSocket(const char* socketPath) {
+#ifdef _WIN32
+    printf("[错误] 当前平台不支持本地套接字服务: %s\n", socketPath);
+    return -1;
+#else
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+    unlink(socketPath);
+    if (server < 0 || bind(server, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(server, 16) != 0) {
+        printf("[错误] 无法监听套接字 %s\n", socketPath);
+        return -1;
+    }
+    fprintf(stderr, "[提示] 批量查询服务已启动: %s\n", socketPath);
+    size_t cap = 1 << 16;
+    char* buf = (char*)malloc(cap);
+    while (1) {
+        int client = accept(server, NULL, NULL);
+        if (client < 0) continue;
+        size_t len = 0;
+        ssize_t r;
+        while ((r = read(client, buf + len, cap - len)) > 0) {
+            len += (size_t)r;
+            if (len == cap) {
+                cap *= 2;
+                buf = (char*)realloc(buf, cap);
+            }
+        }
+        FILE* out = fdopen(client, "w");
+        runBatchQueries(buf, len, out);
+        fclose(out);
+    }
+#endif
+}
+
+// 批量查询菜单
+void batchQueryMenu() {
+    char inPath[260], outPath[260];
+    printf("\n---------- 批量路线查询 ----------\n");
+    printf("查询文件每行一对城市（城市1,城市2 或 城市1 城市2）\n");
+    printf("请输入查询文件路径: ");
+    readerLine(stdinReader(), inPath, sizeof(inPath));
+    inPath[strcspn(inPath, "\n")] = 0;
+    printf("请输入结果文件路径（直接回车输出到屏幕）: ");
+    readerLine(stdinReader(), outPath, sizeof(outPath));
+    outPath[strcspn(outPath, "\n")] = 0;
+    batchQueryFile(inPath, outPath[0] ? outPath : NULL);
+}
+
+// 写入一个数据段（按SNAPSHOT_ALIGN对齐），返回其在文件中的偏移；写失败时流的错误标志被置位，由调用者统一检查
+static long long writeSection(FILE* fp, const void* data, size_t bytes) {
+    static const char zeros[SNAPSHOT_ALIGN] = {0};
+    long long off = ftell(fp);
+    long long pad = (SNAPSHOT_ALIGN - off % SNAPSHOT_ALIGN) % SNAPSHOT_ALIGN;
+    fwrite(zeros, 1, (size_t)pad, fp);
+    fwrite(data, 1, bytes, fp);
+    return off + pad;
+}
+
+// 保存地图快照：城市表、名字池与哈希索引、CSR、连通分量编号及邻接矩阵，成功返回0
+// 任何一步写失败（如磁盘满）都删掉写了一半的文件，免得留下头部看似完整、数据被截断的快照
+int saveSnapshot(const char* path) {
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) {
+        printf("[错误] 无法写入文件 %s\n", path);
+        return -1;
+    }
+    CSRGraph* g = getCSR();
+    int n = graph.numCities;
+    flattenComponents(); // 快照映射只读，打开后不能再做路径压缩，编号必须已经都是根
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    h.version = SNAPSHOT_VERSION;
+    h.byteOrder = SNAPSHOT_BYTE_ORDER;
+    h.numCities = n;
+    h.numArcs = g->offset[n];
+    h.namesLen = graph.namesLen;
+    h.slotCap = graph.slotCap;
+    h.directed = graph.directed;
+    h.hasMatrix = graph.matrix != NULL;
+    fwrite(&h, sizeof(h), 1, fp); // 先占位，最后回填各段偏移
+    h.citiesOff = writeSection(fp, graph.cities, n * sizeof(City));
+    h.namesOff = writeSection(fp, graph.names, graph.namesLen);
+    h.slotsOff = writeSection(fp, graph.nameSlots, graph.slotCap * sizeof(int));
+    h.offsetOff = writeSection(fp, g->offset, (n + 1) * sizeof(int));
+    h.adjOff = writeSection(fp, g->adj, (size_t)h.numArcs * sizeof(int));
+    h.weightOff = writeSection(fp, g->weight, (size_t)h.numArcs * sizeof(int));
+    h.componentOff = writeSection(fp, graph.component, n * sizeof(int));
+    if (h.hasMatrix)
+        h.matrixOff = writeSection(fp, graph.matrix[0], (size_t)n * n * sizeof(int));
+    h.fileSize = ftell(fp);
+    int ok = !ferror(fp) && h.fileSize > 0 && fseek(fp, 0, SEEK_SET) == 0 && fwrite(&h, sizeof(h), 1, fp) == 1;
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) {
+        printf("[错误] 写入文件 %s 失败\n", path);
+        remove(path);
+        return -1;
+    }
+    printf("[提示] 快照已保存到 %s（%.2f MB）\n", path, h.fileSize / 1048576.0);
+    return 0;
+}
+
+// 快照中的一段是否完整落在文件内且按int对齐
+static int snapshotSectionOK(long long off, long long bytes, size_t size) {
+    return off >= (long long)sizeof(SnapshotHeader) && off % (long long)sizeof(int) == 0 &&
+           bytes >= 0 && off <= (long long)size && bytes <= (long long)size - off;
+}
+
+// 校验快照头和各段内容，有效返回1：各段都在文件内，CSR偏移单调、邻居编号合法，
+// 名字偏移和哈希槽不越界，连通分量编号都是根（映射只读，查询时不能再做路径压缩）
+static int validateSnapshot(const SnapshotHeader* h, const char* data, size_t size) {
+    long long n = h->numCities, m = h->numArcs;
+    if (n < 0 || m < 0 || h->namesLen < 0 || h->slotCap < 0 || (h->slotCap & (h->slotCap - 1)) != 0)
+        return 0;
+    if (n > 0 && (h->slotCap == 0 || h->namesLen == 0)) return 0;
+    if (h->hasMatrix && n > DENSE_MATRIX_LIMIT) return 0;
+    if (!snapshotSectionOK(h->citiesOff, n * (long long)sizeof(City), size) ||
+        !snapshotSectionOK(h->namesOff, h->namesLen, size) ||
+        !snapshotSectionOK(h->slotsOff, h->slotCap * (long long)sizeof(int), size) ||
+        !snapshotSectionOK(h->offsetOff, (n + 1) * (long long)sizeof(int), size) ||
+        !snapshotSectionOK(h->adjOff, m * (long long)sizeof(int), size) ||
+        !snapshotSectionOK(h->weightOff, m * (long long)sizeof(int), size) ||
+        !snapshotSectionOK(h->componentOff, n * (long long)sizeof(int), size) ||
+        (h->hasMatrix && !snapshotSectionOK(h->matrixOff, n * n * (long long)sizeof(int), size)))
+        return 0;
+    const City* cities = (const City*)(data + h->citiesOff);
+    const char* names = data + h->namesOff;
+    const int* slots = (const int*)(data + h->slotsOff);
+    const int* offset = (const int*)(data + h->offsetOff);
+    const int* adj = (const int*)(data + h->adjOff);
+    const int* component = (const int*)(data + h->componentOff);
+    if (offset[0] != 0 || offset[n] != m) return 0;
+    for (long long i = 0; i < n; i++)
+        if (offset[i] > offset[i + 1]) return 0;
+    for (long long e = 0; e < m; e++)
+        if (adj[e] < 0 || adj[e] >= n) return 0;
+    if (h->namesLen > 0 && names[h->namesLen - 1] != '\0') return 0;
+    for (long long i = 0; i < n; i++) {
+        if (cities[i].nameOffset < 0 || cities[i].nameOffset >= h->namesLen) return 0;
+        if (component[i] < 0 || component[i] >= n || component[component[i]] != component[i]) return 0;
+    }
+    int empty = 0; // 线性探测靠空槽结束查找，至少要有一个
+    for (int s = 0; s < h->slotCap; s++) {
+        if (slots[s] < -1 || slots[s] >= n) return 0;
+        empty += slots[s] == -1;
+    }
+    return h->slotCap == 0 || empty > 0;
+}
+
+// 映射打开地图快照：各数组直接指向映射内容，只有邻接矩阵的行指针需要分配，成功返回0
+int openSnapshot(const char* path) {
+    size_t size;
+    const char* data = mapFile(path, &size);
+    if (data == NULL) {
+        printf("[错误] 无法打开文件 %s\n", path);
+        return -1;
+    }
+    const SnapshotHeader* h = (const SnapshotHeader*)data;
+    if (size < sizeof(SnapshotHeader) || memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        h->byteOrder != SNAPSHOT_BYTE_ORDER || h->version != SNAPSHOT_VERSION ||
+        h->fileSize != (long long)size) {
+        printf("[错误] %s 不是有效的地图快照（或版本、字节序不匹配）\n", path);
+        unmapFile(data, size);
+        return -1;
+    }
+    if (!validateSnapshot(h, data, size)) {
+        printf("[错误] 地图快照 %s 已损坏\n", path);
+        unmapFile(data, size);
+        return -1;
+    }
+
+    clock_t t0 = clock();
+    freeGraph();
+    int n = h->numCities;
+    graph.snapshot = data;
+    graph.snapshotSize = size;
+    graph.numCities = graph.cityCap = n;
+    graph.cities = (City*)(data + h->citiesOff);
+    graph.names = (char*)(data + h->namesOff);
+    graph.namesLen = graph.namesCap = h->namesLen;
+    graph.nameSlots = (int*)(data + h->slotsOff);
+    graph.slotCap = h->slotCap;
+    graph.directed = h->directed;
+    graph.component = (int*)(data + h->componentOff);
+    graph.array = NULL;
+    csr.n = n;
+    csr.offset = (int*)(data + h->offsetOff);
+    csr.adj = (int*)(data + h->adjOff);
+    csr.weight = (int*)(data + h->weightOff);
+    csr.version = graph.version;
+    if (h->hasMatrix) {
+        graph.matrix = (int**)malloc(n * sizeof(int*));
+        for (int i = 0; i < n; i++)
+            graph.matrix[i] = (int*)(data + h->matrixOff) + (size_t)i * n;
+    }
+    graphCreated = 1;
+    double ms = (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC;
+    printf("[提示] 已打开地图快照: %d个城市, %d条有向弧, 用时 %.3f ms\n", n, h->numArcs, ms);
+    return 0;
+}
+
+// 复制一段映射的数据到堆上
+static void* copyFromSnapshot(const void* src, size_t bytes) {
+    void* dst = malloc(bytes > 0 ? bytes : 1);
+    memcpy(dst, src, bytes);
+    return dst;
+}
+
+// 修改地图之前调用：把指向快照的数组复制到堆上并解除映射，之后与普通地图无异
+void detachSnapshot() {
+    if (graph.snapshot == NULL) return;
+    int n = graph.numCities;
+    int m = csr.offset[n];
+    graph.cities = (City*)copyFromSnapshot(graph.cities, n * sizeof(City));
+    graph.names = (char*)copyFromSnapshot(graph.names, graph.namesLen);
+    graph.nameSlots = (int*)copyFromSnapshot(graph.nameSlots, graph.slotCap * sizeof(int));
+    graph.component = (int*)copyFromSnapshot(graph.component, n * sizeof(int));
+    csr.offset = (int*)copyFromSnapshot(csr.offset, (n + 1) * sizeof(int));
+    csr.adj = (int*)copyFromSnapshot(csr.adj, (size_t)m * sizeof(int));
+    csr.weight = (int*)copyFromSnapshot(csr.weight, (size_t)m * sizeof(int));
+    if (graph.matrix != NULL) {
+        int* block = (int*)copyFromSnapshot(graph.matrix[0], (size_t)n * n * sizeof(int));
+        for (int i = 0; i < n; i++)
+            graph.matrix[i] = block + (size_t)i * n;
+    }
+    unmapFile(graph.snapshot, graph.snapshotSize);
+    graph.snapshot = NULL;
+}
+
+// 解除快照映射（由freeGraph调用）：映射中的数组不能free，只释放矩阵行指针
+void closeSnapshot() {
+    if (graph.snapshot == NULL) return;
+    free(graph.matrix);
+    unmapFile(graph.snapshot, graph.snapshotSize);
+    graph.snapshot = NULL;
+    graph.matrix = NULL;
+    graph.cities = NULL;
+    graph.names = NULL;
+    graph.nameSlots = NULL;
+    graph.component = NULL;
+    csr.offset = csr.adj = csr.weight = NULL;
+}
+
+// 保存快照菜单
+void snapshotMenu() {
+    char path[260];
+    printf("\n---------- 保存地图快照 ----------\n");
+    printf("请输入快照文件路径: ");
+    readerLine(stdinReader(), path, sizeof(path));
+    path[strcspn(path, "\n")] = 0;
+    saveSnapshot(path);
+}
+
+static HuffmanNode* initHuffmanNode(HuffmanNode* node, int symbol, long long freq,
+                                    HuffmanNode* left, HuffmanNode* right) {
+    node->symbol = symbol;
+    node->frequency = freq;
+    node->left = left;
+    node->right = right;
+    return node;
+}
+
+static int huffmanItemLess(HuffmanHeapItem a, HuffmanHeapItem b) {
+    return a.frequency < b.frequency || (a.frequency == b.frequency && a.slot < b.slot);
+}
+
+static void huffmanSiftDown(HuffmanHeapItem heap[], int size, int i) {
+    HuffmanHeapItem item = heap[i];
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= size) break;
+        if (c + 1 < size && huffmanItemLess(heap[c + 1], heap[c])) c++;
+        if (!huffmanItemLess(heap[c], item)) break;
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = item;
+}
+
+// 两队列合并：叶子按频率升序出队，合并结果按生成顺序入队，频率天然有序，每次取两个队首中较小者，O(n)
+// leaves为按频率排好序的(频率, 槽位)，为NULL时表示pool中的叶子本身已升序
+// 同频时优先取叶子，树的形状可能与堆方法不同，但编码总长度同样最优
+static HuffmanNode* buildHuffmanTwoQueue(int n, const HuffmanHeapItem leaves[], HuffmanNode* pool) {
+    int leaf = 0, merged = n, next = n;
+    for (int i = 0; i < n - 1; i++) {
+        HuffmanNode* pick[2];
+        long long sum = 0;
+        for (int k = 0; k < 2; k++) {
+            if (leaf < n) {
+                // 叶子频率从排好序的数组顺序读取，避免随机访问节点
+                long long f = leaves ? leaves[leaf].frequency : pool[leaf].frequency;
+                if (merged == next || f <= pool[merged].frequency) {
+                    pick[k] = &pool[leaves ? leaves[leaf].slot : leaf];
+                    sum += f;
+                    leaf++;
+                    continue;
+                }
+            }
+            sum += pool[merged].frequency;
+            pick[k] = &pool[merged++];
+        }
+        initHuffmanNode(&pool[next++], -1, sum, pick[0], pick[1]);
+    }
+    return &pool[next - 1];
+}
+
+// 对(频率, 槽位)做稳定的LSD基数排序，每趟HUFFMAN_RADIX_BITS位，只排最大频率用到的位
+static HuffmanHeapItem* sortLeavesByFrequency(const long long freqs[], int n, long long maxFreq) {
+    HuffmanHeapItem* items = (HuffmanHeapItem*)malloc(n * sizeof(HuffmanHeapItem));
+    HuffmanHeapItem* tmp = (HuffmanHeapItem*)malloc(n * sizeof(HuffmanHeapItem));
+    int* count = (int*)malloc(((1 << HUFFMAN_RADIX_BITS) + 1) * sizeof(int));
+    const long long mask = (1 << HUFFMAN_RADIX_BITS) - 1;
+    for (int i = 0; i < n; i++) {
+        items[i].frequency = freqs[i];
+        items[i].slot = i;
+    }
+    for (int shift = 0; shift < 64 && (maxFreq >> shift) != 0; shift += HUFFMAN_RADIX_BITS) {
+        memset(count, 0, ((1 << HUFFMAN_RADIX_BITS) + 1) * sizeof(int));
+        for (int i = 0; i < n; i++) count[((items[i].frequency >> shift) & mask) + 1]++;
+        for (int d = 0; d < (1 << HUFFMAN_RADIX_BITS); d++) count[d + 1] += count[d];
+        for (int i = 0; i < n; i++) tmp[count[(items[i].frequency >> shift) & mask]++] = items[i];
+        HuffmanHeapItem* t = items; items = tmp; tmp = t;
+    }
+    free(count);
+    free(tmp);
+    return items;
+}
+
+// 构建赫夫曼树，pool至少容纳2n-1个节点：前n个依次为叶子，之后为合并产生的内部节点，调用者负责释放
+// 少量符号（交互输入）用小顶堆：每次取出(频率, 槽位)最小的两个节点，合并结果占用最小者的槽位，
+// 与逐个扫描找两个最小值的做法得到完全相同的树；大字母表先按频率基数排序（已升序则跳过），再两队列合并
+HuffmanNode* buildHuffmanTree(const int symbols[], const long long freqs[], int n, HuffmanNode* pool) {
+    if (n <= 0) return NULL;
+    int sorted = 1, negative = 0;
+    long long maxFreq = 0;
+    for (int i = 0; i < n; i++) {
+        initHuffmanNode(&pool[i], symbols[i], freqs[i], NULL, NULL);
+        if (i > 0 && freqs[i] < freqs[i - 1]) sorted = 0;
+        if (freqs[i] < 0) negative = 1;
+        if (freqs[i] > maxFreq) maxFreq = freqs[i];
+    }
+    if (n >= HUFFMAN_LINEAR_MIN && !negative) {
+        if (sorted) return buildHuffmanTwoQueue(n, NULL, pool);
+        HuffmanHeapItem* leaves = sortLeavesByFrequency(freqs, n, maxFreq);
+        HuffmanNode* root = buildHuffmanTwoQueue(n, leaves, pool);
+        free(leaves);
+        return root;
+    }
+
+    HuffmanHeapItem* heap = (HuffmanHeapItem*)malloc(n * sizeof(HuffmanHeapItem));
+    HuffmanNode** slotNode = (HuffmanNode**)malloc(n * sizeof(HuffmanNode*));
+    for (int i = 0; i < n; i++) {
+        heap[i].frequency = freqs[i];
+        heap[i].slot = i;
+        slotNode[i] = &pool[i];
+    }
+    for (int i = n / 2 - 1; i >= 0; i--) huffmanSiftDown(heap, n, i);
+
+    int size = n, next = n;
+    while (size > 1) {
+        // 取出最小的两个：弹出堆顶，第二小此时在堆顶，直接用合并结果替换它
+        HuffmanHeapItem min1 = heap[0];
+        heap[0] = heap[--size];
+        huffmanSiftDown(heap, size, 0);
+        HuffmanHeapItem min2 = heap[0];
+        HuffmanNode* newNode = initHuffmanNode(&pool[next++], -1, min1.frequency + min2.frequency,
+                                               slotNode[min1.slot], slotNode[min2.slot]);
+        slotNode[min1.slot] = newNode;
+        heap[0].frequency = newNode->frequency;
+        heap[0].slot = min1.slot;
+        huffmanSiftDown(heap, size, 0);
+    }
+    HuffmanNode* root = slotNode[heap[0].slot];
+    free(heap);
+    free(slotNode);
+    return root;
+}
+
+// 构建赫夫曼树
+void huffmanTree() {
+    int n, i;
+    printf("请输入城市数量: ");
+    if (!readerInt(stdinReader(), &n) || n <= 0) {
+        printf("城市数量无效！\n");
+        readerSkipLine(stdinReader());
+        return;
+    }
+    readerChar(stdinReader());
+    int* symbols = (int*)malloc(n * sizeof(int));
+    long long* freqs = (long long*)malloc(n * sizeof(long long));
+    for (i = 0; i < n; i++) {
+        char code;
+        printf("请输入第%d个城市的编码（单个字母）: ", i+1);
+        code = (char)readerChar(stdinReader());
+        readerChar(stdinReader());
+        symbols[i] = (unsigned char)code;
         printf("请输入查询次数: ");
-        scanf("%d", &freqs[i]);
-        getchar();
+        readerLongLong(stdinReader(), &freqs[i]);
+        readerChar(stdinReader());
+    }
+    HuffmanNode* pool = (HuffmanNode*)malloc((2 * (size_t)n - 1) * sizeof(HuffmanNode));
+    HuffmanNode* root = buildHuffmanTree(symbols, freqs, n, pool);
+    root->symbol = '#';
+    printf("赫夫曼树层次遍历:\n");
+    levelOrderTraversal_Hu(root);
+
+    // 由树的码长得到范式编码
+    unsigned char* length = (unsigned char*)malloc(n);
+    huffmanCodeLengths(pool, n, length, HUFFMAN_MAX_CODE_LEN);
+    HuffmanCode* hc = huffmanCodeFromLengths(length, n);
+    printf("范式赫夫曼编码:\n");
+    for (i = 0; i < n && i < PRINT_LIMIT; i++) {
+        printf("%c: ", symbols[i]);
+        for (int b = hc->length[i] - 1; b >= 0; b--) putchar('0' + ((hc->code[i] >> b) & 1));
+        printf("\n");
+    }
+    freeHuffmanCode(hc);
+    free(length);
+    free(pool);
+    free(symbols);
+    free(freqs);
+}
+
+// 由赫夫曼树求各叶子的码长，超过maxLen时调整为长度受限的编码
+// 内部节点在pool中的下标总大于其孩子，按下标从大到小即可自顶向下求深度，不需要递归
+// 限长采用JPEG标准附录K的调整法：把最深层的两个码字并到上层，再从较浅层拆出一个码字补位，
+// 然后按原深度从浅到深把调整后的码长依次分给各符号，频率高的仍拿到较短的码
+void huffmanCodeLengths(const HuffmanNode* pool, int n, unsigned char length[], int maxLen) {
+    if (n == 1) {
+        length[0] = 1; // 只有一个符号时也占1位
+        return;
+    }
+    int total = 2 * n - 1;
+    int* depth = (int*)malloc(total * sizeof(int));
+    int maxDepth = 0;
+    depth[total - 1] = 0;
+    for (int i = total - 1; i >= n; i--) {
+        depth[pool[i].left - pool] = depth[pool[i].right - pool] = depth[i] + 1;
+        if (depth[i] + 1 > maxDepth) maxDepth = depth[i] + 1;
+    }
+
+    // 按深度计数，并把符号按深度稳定排序
+    int* count = (int*)calloc(maxDepth + 2, sizeof(int));
+    int* order = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) count[depth[i] + 1]++;
+    for (int d = 0; d <= maxDepth; d++) count[d + 1] += count[d];
+    for (int i = 0; i < n; i++) order[count[depth[i]]++] = i;
+    memset(count, 0, (maxDepth + 2) * sizeof(int));
+    for (int i = 0; i < n; i++) count[depth[i]]++;
+
+    for (int d = maxDepth; d > maxLen; d--) {
+        while (count[d] > 0) {
+            int j = d - 2;
+            while (count[j] == 0) j--;
+            count[d] -= 2;
+            count[d - 1]++;
+            count[j + 1] += 2;
+            count[j]--;
+        }
+    }
+    for (int d = 1, k = 0; d <= maxDepth && d <= maxLen; d++)
+        for (int c = 0; c < count[d]; c++)
+            length[order[k++]] = (unsigned char)d;
+    free(order);
+    free(count);
+    free(depth);
+}
+
+// 从文件读出的码长要先检查：每个码长在1到HUFFMAN_MAX_CODE_LEN之间，且满足Kraft不等式（Σ2^-len<=1），
+// 否则huffmanCodeFromLengths会越界访问lenCount，或算出超出码长的码字写到解码表外
+int huffmanLengthsValid(const unsigned char length[], int n) {
+    unsigned long long kraft = 0; // 以2^-HUFFMAN_MAX_CODE_LEN为单位
+    for (int i = 0; i < n; i++) {
+        if (length[i] < 1 || length[i] > HUFFMAN_MAX_CODE_LEN) return 0;
+        kraft += 1ULL << (HUFFMAN_MAX_CODE_LEN - length[i]);
+    }
+    return kraft <= 1ULL << HUFFMAN_MAX_CODE_LEN;
+}
+
+// 由码长恢复范式编码：分配码字并建立多符号解码表
+HuffmanCode* huffmanCodeFromLengths(const unsigned char length[], int n) {
+    HuffmanCode* hc = (HuffmanCode*)calloc(1, sizeof(HuffmanCode));
+    hc->numSymbols = n;
+    hc->length = (unsigned char*)malloc(n);
+    hc->code = (unsigned*)malloc(n * sizeof(unsigned));
+    hc->sorted = (int*)malloc(n * sizeof(int));
+    memcpy(hc->length, length, n);
+    for (int i = 0; i < n; i++) {
+        hc->lenCount[length[i]]++;
+        if (length[i] > hc->maxLen) hc->maxLen = length[i];
+    }
+
+    // 同码长的符号按编号取连续码字，更长一级的首码字是上一级末码字加一再左移一位
+    int next[HUFFMAN_MAX_CODE_LEN + 1];
+    unsigned long long code = 0;
+    for (int len = 1, index = 0; len <= HUFFMAN_MAX_CODE_LEN; len++) {
+        code = (code + hc->lenCount[len - 1]) << 1;
+        hc->firstCode[len] = code;
+        hc->firstIndex[len] = next[len] = index;
+        index += hc->lenCount[len];
+    }
+    for (int i = 0; i < n; i++) {
+        int len = length[i];
+        int k = next[len]++;
+        hc->sorted[k] = i;
+        hc->code[i] = (unsigned)(hc->firstCode[len] + (k - hc->firstIndex[len]));
+    }
+
+    // 先建单符号表，再在每个表项剩余的位里继续查，把能完整解出的后续符号并进来
+    int size = 1 << HUFFMAN_TABLE_BITS;
+    HuffmanDecodeEntry* single = (HuffmanDecodeEntry*)calloc(size, sizeof(HuffmanDecodeEntry));
+    for (int len = 1; len <= HUFFMAN_TABLE_BITS; len++) {
+        for (int k = hc->firstIndex[len]; k < hc->firstIndex[len] + hc->lenCount[len]; k++) {
+            int sym = hc->sorted[k];
+            int start = (int)(hc->code[sym] << (HUFFMAN_TABLE_BITS - len));
+            for (int j = start; j < start + (1 << (HUFFMAN_TABLE_BITS - len)); j++) {
+                single[j].symbols[0] = sym;
+                single[j].count = 1;
+                single[j].bits = (unsigned char)len;
+            }
+        }
+    }
+    hc->table = (HuffmanDecodeEntry*)malloc(size * sizeof(HuffmanDecodeEntry));
+    for (int j = 0; j < size; j++) {
+        HuffmanDecodeEntry e = single[j];
+        while (e.count > 0 && e.count < HUFFMAN_TABLE_SYMS) {
+            const HuffmanDecodeEntry* more = &single[(j << e.bits) & (size - 1)];
+            if (more->count == 0 || e.bits + more->bits > HUFFMAN_TABLE_BITS) break;
+            e.symbols[e.count++] = more->symbols[0];
+            e.bits += more->bits;
+        }
+        hc->table[j] = e;
+    }
+    free(single);
+    return hc;
+}
+
+// 由频率构建范式赫夫曼编码，maxLen为码长上限（0或超过HUFFMAN_MAX_CODE_LEN时取HUFFMAN_MAX_CODE_LEN）
+HuffmanCode* buildHuffmanCode(const long long freqs[], int n, int maxLen) {
+    if (maxLen <= 0 || maxLen > HUFFMAN_MAX_CODE_LEN) maxLen = HUFFMAN_MAX_CODE_LEN;
+    while ((1LL << maxLen) < n) maxLen++; // 码长上限至少要容纳全部符号
+    int* symbols = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) symbols[i] = i;
+    HuffmanNode* pool = (HuffmanNode*)malloc((2 * (size_t)n - 1) * sizeof(HuffmanNode));
+    buildHuffmanTree(symbols, freqs, n, pool);
+    unsigned char* length = (unsigned char*)malloc(n);
+    huffmanCodeLengths(pool, n, length, maxLen);
+    HuffmanCode* hc = huffmanCodeFromLengths(length, n);
+    free(length);
+    free(pool);
+    free(symbols);
+    return hc;
+}
+
+void freeHuffmanCode(HuffmanCode* hc) {
+    if (hc == NULL) return;
+    free(hc->length);
+    free(hc->code);
+    free(hc->sorted);
+    free(hc->table);
+    free(hc);
+}
+
+// 按高位在前把码字依次写入out，末尾补8字节0供解码器越界预读，返回写入的字节数
+// out至少需要 (各符号码长之和 + 7) / 8 + 8 字节
+size_t huffmanEncode(const HuffmanCode* hc, const int symbols[], long long count, unsigned char* out) {
+    unsigned long long acc = 0;
+    int nbits = 0;
+    size_t pos = 0;
+    for (long long i = 0; i < count; i++) {
+        int len = hc->length[symbols[i]];
+        acc = (acc << len) | hc->code[symbols[i]]; // 写入前nbits<8，码长不超过32，不会溢出
+        nbits += len;
+        while (nbits >= 8) {
+            nbits -= 8;
+            out[pos++] = (unsigned char)(acc >> nbits);
+        }
+    }
+    if (nbits > 0) out[pos++] = (unsigned char)(acc << (8 - nbits));
+    memset(out + pos, 0, 8);
+    return pos + 8;
+}
+
+// 从第pos位起按高位在前读出64位
+static inline unsigned long long peekBits(const unsigned char* in, unsigned long long pos) {
+    unsigned long long w;
+    memcpy(&w, in + (pos >> 3), sizeof(w));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    return w << (pos & 7);
+}
+
+// 码字比查找表索引长时，按码长逐级与范式编码的区间比较
+static inline int decodeLongSymbol(const HuffmanCode* hc, unsigned long long bits, int* len) {
+    for (int l = HUFFMAN_TABLE_BITS + 1; l <= hc->maxLen; l++) {
+        unsigned long long offset = (bits >> (64 - l)) - hc->firstCode[l];
+        if (offset < (unsigned long long)hc->lenCount[l]) {
+            *len = l;
+            return hc->sorted[hc->firstIndex[l] + offset];
+        }
+    }
+    *len = hc->maxLen; // 码流损坏
+    return 0;
+}
+
+// 解出count个符号，in共inBytes字节（不少于8），需以huffmanEncode的8字节填充结尾
+// 主循环每次查表最多解出HUFFMAN_TABLE_SYMS个符号，剩余不足时逐个解码，避免把填充位当成符号
+// 码流读到填充区之后说明文件损坏（count比实际的多），返回-1，正常返回0
+int huffmanDecode(const HuffmanCode* hc, const unsigned char* in, size_t inBytes, int symbols[], long long count) {
+    const unsigned long long limit = (inBytes - 8) * 8ULL; // 读取位置不超过它时peekBits不会越界
+    unsigned long long pos = 0;
+    long long i = 0;
+    int len;
+    while (i + HUFFMAN_TABLE_SYMS <= count) {
+        if (pos > limit) return -1;
+        unsigned long long bits = peekBits(in, pos);
+        const HuffmanDecodeEntry* e = &hc->table[bits >> (64 - HUFFMAN_TABLE_BITS)];
+        if (e->count > 0) {
+            for (int k = 0; k < HUFFMAN_TABLE_SYMS; k++) symbols[i + k] = e->symbols[k];
+            i += e->count;
+            pos += e->bits;
+        } else {
+            symbols[i++] = decodeLongSymbol(hc, bits, &len);
+            pos += len;
+        }
+    }
+    while (i < count) {
+        if (pos > limit) return -1;
+        unsigned long long bits = peekBits(in, pos);
+        const HuffmanDecodeEntry* e = &hc->table[bits >> (64 - HUFFMAN_TABLE_BITS)];
+        if (e->count > 0) {
+            symbols[i++] = e->symbols[0];
+            pos += hc->length[e->symbols[0]];
+        } else {
+            symbols[i++] = decodeLongSymbol(hc, bits, &len);
+            pos += len;
+        }
+    }
+    return 0;
+}
+
+static void initNameDict(NameDict* d) {
+    d->textLen = 0;
+    d->textCap = 1 << 16;
+    d->text = (char*)malloc(d->textCap);
+    d->count = 0;
+    d->cap = 1024;
+    d->start = (size_t*)malloc(d->cap * sizeof(size_t));
+    d->len = (int*)malloc(d->cap * sizeof(int));
+    d->tableCap = 2048;
+    d->table = (int*)malloc(d->tableCap * sizeof(int));
+    memset(d->table, -1, d->tableCap * sizeof(int));
+}
+
+static void freeNameDict(NameDict* d) {
+    free(d->text);
+    free(d->start);
+    free(d->len);
+    free(d->table);
+}
+
+// 查找名字的编号，不存在返回-1
+static int findName(const NameDict* d, const char* name, int len, unsigned h) {
+    for (int slot = h & (d->tableCap - 1); d->table[slot] != -1; slot = (slot + 1) & (d->tableCap - 1)) {
+        int id = d->table[slot];
+        if (d->len[id] == len && memcmp(d->text + d->start[id], name, len) == 0) return id;
     }
-    HuffmanNode* root = buildHuffmanTree(codes, freqs, n);
-    root->cityCode = '#'; 
-    printf("赫夫曼树层次遍历:\n");
-    levelOrderTraversal_Hu(root);
+    return -1;
 }
 
-// 层次遍历赫夫曼树
-void levelOrderTraversal_Hu(HuffmanNode* root) {
-    if (root == NULL) {
-        printf("树为空！\n");
-        return;
+// 加入一个新名字（调用者保证不存在），返回其编号
+static int addName(NameDict* d, const char* name, int len, unsigned h) {
+    if (d->count == d->cap) {
+        d->cap *= 2;
+        d->start = (size_t*)realloc(d->start, d->cap * sizeof(size_t));
+        d->len = (int*)realloc(d->len, d->cap * sizeof(int));
+    }
+    while (d->textLen + len > d->textCap) {
+        d->textCap *= 2;
+        d->text = (char*)realloc(d->text, d->textCap);
+    }
+    int id = d->count++;
+    memcpy(d->text + d->textLen, name, len);
+    d->start[id] = d->textLen;
+    d->len[id] = len;
+    d->textLen += len;
+    if (d->count * 2 > d->tableCap) { // 装载因子超过一半时扩容重排
+        d->tableCap *= 2;
+        d->table = (int*)realloc(d->table, d->tableCap * sizeof(int));
+        memset(d->table, -1, d->tableCap * sizeof(int));
+        for (int s = 0; s < d->count; s++) {
+            int k = hashName(d->text + d->start[s], d->len[s]) & (d->tableCap - 1);
+            while (d->table[k] != -1) k = (k + 1) & (d->tableCap - 1);
+            d->table[k] = s;
+        }
+    } else {
+        int k = h & (d->tableCap - 1);
+        while (d->table[k] != -1) k = (k + 1) & (d->tableCap - 1);
+        d->table[k] = id;
+    }
+    return id;
+}
+
+static int internName(NameDict* d, const char* name, int len) {
+    unsigned h = hashName(name, len);
+    int id = findName(d, name, len, h);
+    return id != -1 ? id : addName(d, name, len, h);
+}
+
+// 压缩查询日志：每行作为一个符号（不同的行即不同的城市名），成功返回0
+int compressQueryLog(const char* inPath, const char* outPath, int maxLen) {
+    size_t size;
+    const char* data = mapFile(inPath, &size);
+    if (data == NULL) {
+        printf("[错误] 无法打开文件 %s\n", inPath);
+        return -1;
+    }
+    clock_t t0 = clock();
+    NameDict dict;
+    initNameDict(&dict);
+    long long numLines = 0, lineCap = 1 << 16;
+    int* lines = (int*)malloc(lineCap * sizeof(int));
+    for (size_t p = 0; p < size;) {
+        const char* end = (const char*)memchr(data + p, '\n', size - p);
+        int len = (int)((end ? (size_t)(end - data) : size) - p);
+        if (numLines == lineCap) {
+            lineCap *= 2;
+            lines = (int*)realloc(lines, lineCap * sizeof(int));
+        }
+        lines[numLines++] = internName(&dict, data + p, len);
+        p += len + (end != NULL);
+    }
+
+    FILE* fp = NULL;
+    if (numLines == 0)
+        printf("[错误] 日志 %s 为空\n", inPath);
+    else if ((fp = fopen(outPath, "wb")) == NULL)
+        printf("[错误] 无法写入文件 %s\n", outPath);
+    if (fp == NULL) {
+        freeNameDict(&dict);
+        free(lines);
+        unmapFile(data, size);
+        return -1;
+    }
+    int numSymbols = dict.count;
+    long long* freqs = (long long*)calloc(numSymbols, sizeof(long long));
+    for (long long i = 0; i < numLines; i++) freqs[lines[i]]++;
+    HuffmanCode* hc = buildHuffmanCode(freqs, numSymbols, maxLen);
+    long long totalBits = 0;
+    for (int s = 0; s < numSymbols; s++) totalBits += freqs[s] * hc->length[s];
+    unsigned char* stream = (unsigned char*)malloc((size_t)((totalBits + 7) / 8 + 8));
+
+    HuffmanLogHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, HUFFMAN_LOG_MAGIC, sizeof(HUFFMAN_LOG_MAGIC));
+    h.numSymbols = numSymbols;
+    h.maxLen = hc->maxLen;
+    h.numLines = numLines;
+    h.streamBytes = (long long)huffmanEncode(hc, lines, numLines, stream);
+    h.trailingNewline = size > 0 && data[size - 1] == '\n';
+    h.dictBytes = (long long)dict.textLen + numSymbols;
+    double ms = (double)(clock() - t0) * 1000.0 / CLOCKS_PER_SEC;
+
+    fwrite(&h, sizeof(h), 1, fp);
+    for (int s = 0; s < numSymbols; s++) {
+        fwrite(dict.text + dict.start[s], 1, dict.len[s], fp);
+        fputc('\n', fp);
+    }
+    fwrite(hc->length, 1, numSymbols, fp);
+    fwrite(stream, 1, (size_t)h.streamBytes, fp);
+    long long outBytes = ftell(fp);
+    int ok = fclose(fp) == 0;
+    if (ok)
+        printf("[提示] %lld行, %d个不同城市名, 平均码长%.2f位, 最长%d位; %zu -> %lld 字节(%.1f%%), 用时 %.1f ms\n",
+               numLines, numSymbols, (double)totalBits / numLines, hc->maxLen, size, outBytes,
+               size > 0 ? outBytes * 100.0 / size : 0.0, ms);
+    else
+        printf("[错误] 写入文件 %s 失败\n", outPath);
+    freeHuffmanCode(hc);
+    free(stream);
+    free(freqs);
+    free(lines);
+    freeNameDict(&dict);
+    unmapFile(data, size);
+    return ok ? 0 : -1;
+}
+
+// 解压查询日志，成功返回0
+int decompressQueryLog(const char* inPath, const char* outPath) {
+    size_t size;
+    const char* data = mapFile(inPath, &size);
+    if (data == NULL) {
+        printf("[错误] 无法打开文件 %s\n", inPath);
+        return -1;
+    }
+    const HuffmanLogHeader* h = (const HuffmanLogHeader*)data;
+    if (size < sizeof(HuffmanLogHeader) || memcmp(h->magic, HUFFMAN_LOG_MAGIC, sizeof(HUFFMAN_LOG_MAGIC)) != 0 ||
+        h->maxLen > HUFFMAN_MAX_CODE_LEN || h->numSymbols < 1 || h->numLines < 1 ||
+        h->dictBytes < 0 || h->dictBytes > (long long)size || h->streamBytes < 8 || h->streamBytes > (long long)size ||
+        (long long)size != (long long)sizeof(HuffmanLogHeader) + h->dictBytes + h->numSymbols + h->streamBytes ||
+        h->numLines > (h->streamBytes - 8) * 8) { // 每行至少1位
+        printf("[错误] %s 不是有效的压缩日志\n", inPath);
+        unmapFile(data, size);
+        return -1;
+    }
+    int n = h->numSymbols;
+    const char* dict = data + sizeof(HuffmanLogHeader);
+    const unsigned char* length = (const unsigned char*)dict + h->dictBytes;
+    const unsigned char* stream = length + n;
+    int* nameStart = (int*)malloc((n + 1) * sizeof(int)); // 第s个名字占[nameStart[s], nameStart[s+1]-1)
+    nameStart[0] = 0;
+    int valid = huffmanLengthsValid(length, n);
+    for (int s = 0; s < n && valid; s++) {
+        const char* nl = (const char*)memchr(dict + nameStart[s], '\n', h->dictBytes - nameStart[s]);
+        if (nl == NULL) valid = 0; // 字典里的名字不够numSymbols个
+        else nameStart[s + 1] = (int)(nl - dict) + 1;
+    }
+    if (!valid) {
+        printf("[错误] %s 已损坏\n", inPath);
+        free(nameStart);
+        unmapFile(data, size);
+        return -1;
+    }
+
+    clock_t t0 = clock();
+    HuffmanCode* hc = huffmanCodeFromLengths(length, n);
+    int* lines = (int*)malloc(h->numLines * sizeof(int));
+    if (huffmanDecode(hc, stream, (size_t)h->streamBytes, lines, h->numLines) != 0) {
+        printf("[错误] %s 已损坏\n", inPath);
+        free(lines);
+        free(nameStart);
+        freeHuffmanCode(hc);
+        unmapFile(data, size);
+        return -1;
+    }
+    size_t outSize = 0;
+    for (long long i = 0; i < h->numLines; i++) outSize += nameStart[lines[i] + 1] - nameStart[lines[i]];
+    char* out = (char*)malloc(outSize);
+    size_t q = 0;
+    for (long long i = 0; i < h->numLines; i++) {
+        int len = nameStart[lines[i] + 1] - nameStart[lines[i]]; // 含换行
+        memcpy(out + q, dict + nameStart[lines[i]], len);
+        q += len;
+    }
+    if (!h->trailingNewline) outSize--;
+    double sec = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    FILE* fp = fopen(outPath, "wb");
+    int ok = fp != NULL && fwrite(out, 1, outSize, fp) == outSize;
+    if (fp != NULL && fclose(fp) != 0) ok = 0;
+    if (ok)
+        printf("[提示] 已解压%lld行到 %s, 解码用时 %.1f ms（%.0f MB/s）\n", h->numLines, outPath,
+               sec * 1000, sec > 0 ? outSize / sec / 1048576.0 : 0.0);
+    else
+        printf("[错误] 无法写入文件 %s\n", outPath);
+    free(out);
+    free(lines);
+    free(nameStart);
+    freeHuffmanCode(hc);
+    unmapFile(data, size);
+    return ok ? 0 : -1;
+}
+
+static void initBitWriter(BitWriter* w) {
+    w->cap = 1 << 16;
+    w->buf = (unsigned char*)malloc(w->cap);
+    w->pos = 0;
+    w->acc = 0;
+    w->nbits = 0;
+}
+
+// 写入value的低len位（len不超过32）
+static inline void putBits(BitWriter* w, unsigned value, int len) {
+    if (w->pos + 8 > w->cap) {
+        w->cap *= 2;
+        w->buf = (unsigned char*)realloc(w->buf, w->cap);
+    }
+    w->acc = (w->acc << len) | value;
+    w->nbits += len;
+    while (w->nbits >= 8) {
+        w->nbits -= 8;
+        w->buf[w->pos++] = (unsigned char)(w->acc >> w->nbits);
+    }
+}
+
+// 已写入的位数
+static inline long long bitsWritten(const BitWriter* w) {
+    return (long long)w->pos * 8 + w->nbits;
+}
+
+// 结束当前一段码流：补齐最后一个字节并追加8字节0，写出段头、编码表和码流后清空
+static void writeLogSegment(FILE* fp, BitWriter* w, int numLines, const HuffmanCode* hc) {
+    if (w->nbits > 0) putBits(w, 0, 8 - w->nbits);
+    putBits(w, 0, 32);
+    putBits(w, 0, 32);
+    LogSegmentHeader sh;
+    sh.numLines = numLines;
+    sh.numSymbols = hc->numSymbols - 1;
+    sh.streamBytes = (long long)w->pos;
+    fwrite(&sh, sizeof(sh), 1, fp);
+    fwrite(hc->length, 1, hc->numSymbols, fp);
+    fwrite(w->buf, 1, w->pos, fp);
+    w->pos = 0;
+    w->acc = 0;
+}
+
+// 后台线程：按频率快照建表，建好后原子地发布给编码线程
+#ifdef _WIN32
+static DWORD WINAPI rebuildCodeThread(LPVOID arg)
+#else
+static void* rebuildCodeThread(void* arg)
+#endif
+{
+    CodeRebuildJob* job = (CodeRebuildJob*)arg;
+    HuffmanCode* hc = buildHuffmanCode(job->freqs, job->n, job->maxLen);
+    free(job->freqs);
+    __atomic_store_n(job->result, hc, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// 从in读取至多maxLines行，行内容依次存入text（不含换行），第k行为[offs[k], offs[k+1])，返回行数
+static int readLogChunk(FILE* in, char** text, size_t* cap, size_t offs[], int maxLines) {
+    size_t len = 0;
+    int n = 0;
+    offs[0] = 0;
+    while (n < maxLines) {
+        if (*cap - len < 4096) {
+            *cap *= 2;
+            *text = (char*)realloc(*text, *cap);
+        }
+        if (fgets(*text + len, (int)(*cap - len), in) == NULL) break;
+        len += strlen(*text + len);
+        if ((*text)[len - 1] == '\n') offs[++n] = --len; // 超长的行会分几次读完
+    }
+    if (len > offs[n]) offs[++n] = len; // 最后一行没有换行
+    return n;
+}
+
+// 把各线程的局部直方图累加到全局频率并清零，循环连续访问，可被编译器向量化
+static void mergeHistograms(unsigned* hist, int threads, int histCap, long long freq[], int count) {
+    for (int t = 0; t < threads; t++) {
+        unsigned* local = hist + (size_t)t * histCap;
+        for (int i = 0; i < count; i++) {
+            freq[i] += local[i];
+            local[i] = 0;
+        }
+    }
+}
+
+// 流式压缩查询日志：边读边编码，编码表在后台按最新频率重建，建好后在块边界切换，编码从不等待建表
+// 每次合并直方图时（至少隔字典大小那么多行，使每段开头的编码表开销可以摊薄）检查这一窗口：
+// 每行平均位数比换表后第一个窗口差了threshold（如0.05表示5%）以上，或转义写出的新城市名
+// 占了threshold以上的位数，就触发重建。解压时每行都以换行结尾
+int streamCompressLog(FILE* in, const char* outPath, double threshold) {
+    FILE* fp = fopen(outPath, "wb");
+    if (fp == NULL) {
+        printf("[错误] 无法写入文件 %s\n", outPath);
+        return -1;
+    }
+    fwrite(LOG_STREAM_MAGIC, 1, sizeof(LOG_STREAM_MAGIC), fp);
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    NameDict dict;
+    initNameDict(&dict);
+    size_t textCap = 1 << 20;
+    char* text = (char*)malloc(textCap);
+    size_t* offs = (size_t*)malloc((LOG_STREAM_CHUNK + 1) * sizeof(size_t));
+    int* ids = (int*)malloc(LOG_STREAM_CHUNK * sizeof(int));
+    int histCap = 1024;
+    unsigned* hist = (unsigned*)calloc((size_t)threads * histCap, sizeof(unsigned));
+    long long* freq = (long long*)calloc(histCap, sizeof(long long));
+    long long escapes = 0, sinceMerge = 0, totalLines = 0, inBytes = 0;
+
+    long long one = 1;
+    HuffmanCode* code = buildHuffmanCode(&one, 1, 0); // 初始编码表只有转义符
+    int codeSymbols = 0;
+    HuffmanCode* pending = NULL; // 后台建好的新表
+    int rebuilding = 0, segments = 0, swaps = 0, segLines = 0;
+    double baseline = -1; // 换表后第一个窗口的每行平均位数
+    long long windowBits = 0, windowEscBits = 0;
+    CodeRebuildJob job;
+#ifdef _WIN32
+    HANDLE worker = NULL;
+#else
+    pthread_t worker;
+#endif
+    BitWriter w;
+    initBitWriter(&w);
+
+    int n;
+    while ((n = readLogChunk(in, &text, &textCap, offs, LOG_STREAM_CHUNK)) > 0) {
+        // 并行查字典并计入各线程的局部直方图，字典此时只读
+        #pragma omp parallel
+        {
+            int t = 0;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+#endif
+            unsigned* local = hist + (size_t)t * histCap;
+            #pragma omp for schedule(static)
+            for (int k = 0; k < n; k++) {
+                int len = (int)(offs[k + 1] - offs[k]);
+                ids[k] = findName(&dict, text + offs[k], len, hashName(text + offs[k], len));
+                if (ids[k] != -1) local[ids[k]]++;
+            }
+        }
+        // 新名字按出现顺序串行加入，解压端据此得到相同的编号
+        for (int k = 0; k < n; k++) {
+            if (ids[k] != -1) continue;
+            ids[k] = internName(&dict, text + offs[k], (int)(offs[k + 1] - offs[k]));
+            if (dict.count > histCap) {
+                int newCap = histCap * 2;
+                unsigned* grown = (unsigned*)calloc((size_t)threads * newCap, sizeof(unsigned));
+                for (int t = 0; t < threads; t++)
+                    memcpy(grown + (size_t)t * newCap, hist + (size_t)t * histCap, histCap * sizeof(unsigned));
+                free(hist);
+                hist = grown;
+                freq = (long long*)realloc(freq, newCap * sizeof(long long));
+                memset(freq + histCap, 0, (newCap - histCap) * sizeof(long long));
+                histCap = newCap;
+            }
+            hist[ids[k]]++;
+        }
+
+        // 后台的新表已就绪：结束当前段，换表
+        HuffmanCode* fresh = __atomic_exchange_n(&pending, NULL, __ATOMIC_ACQ_REL);
+        if (fresh != NULL) {
+#ifdef _WIN32
+            WaitForSingleObject(worker, INFINITE);
+            CloseHandle(worker);
+#else
+            pthread_join(worker, NULL);
+#endif
+            rebuilding = 0;
+            if (segLines > 0) {
+                writeLogSegment(fp, &w, segLines, code);
+                segments++;
+                segLines = 0;
+            }
+            freeHuffmanCode(code);
+            code = fresh;
+            codeSymbols = code->numSymbols - 1;
+            baseline = -1;
+            swaps++;
+        }
+
+        long long bits0 = bitsWritten(&w);
+        for (int k = 0; k < n; k++) {
+            int id = ids[k];
+            if (id < codeSymbols) {
+                putBits(&w, code->code[id], code->length[id]);
+                continue;
+            }
+            const char* name = text + offs[k];
+            int len = (int)(offs[k + 1] - offs[k]);
+            putBits(&w, code->code[codeSymbols], code->length[codeSymbols]);
+            putBits(&w, (unsigned)len, 32);
+            for (int b = 0; b < len; b++) putBits(&w, (unsigned char)name[b], 8);
+            windowEscBits += code->length[codeSymbols] + 32 + 8 * len;
+            escapes++;
+        }
+        long long chunkBytes = (long long)offs[n] + n;
+        windowBits += bitsWritten(&w) - bits0;
+        totalLines += n;
+        inBytes += chunkBytes;
+        segLines += n;
+        sinceMerge += n;
+        if (segLines >= LOG_STREAM_SEGMENT) {
+            writeLogSegment(fp, &w, segLines, code);
+            segments++;
+            segLines = 0;
+        }
+
+        if (sinceMerge < LOG_STREAM_MERGE_MIN || sinceMerge < dict.count) continue;
+        mergeHistograms(hist, threads, histCap, freq, dict.count);
+        double bitsPerLine = (double)windowBits / sinceMerge;
+        // 新名字省下的位数要超过新编码表本身（每个符号1字节码长）才值得换表
+        int degraded = (windowEscBits > threshold * windowBits && windowEscBits > 8LL * dict.count) ||
+                       (baseline > 0 && bitsPerLine > baseline * (1 + threshold));
+        if (baseline < 0) baseline = bitsPerLine;
+        sinceMerge = windowBits = windowEscBits = 0;
+        if (!rebuilding && degraded) {
+            // 取频率快照交给后台线程，旧计数减半以跟上频率的漂移
+            job.n = dict.count + 1;
+            job.maxLen = 0;
+            job.result = &pending;
+            job.freqs = (long long*)malloc(job.n * sizeof(long long));
+            memcpy(job.freqs, freq, dict.count * sizeof(long long));
+            job.freqs[dict.count] = escapes + 1;
+            for (int i = 0; i < dict.count; i++) freq[i] >>= 1;
+            escapes = 0;
+#ifdef _WIN32
+            worker = CreateThread(NULL, 0, rebuildCodeThread, &job, 0, NULL);
+            rebuilding = worker != NULL;
+#else
+            rebuilding = pthread_create(&worker, NULL, rebuildCodeThread, &job) == 0;
+#endif
+            if (!rebuilding) free(job.freqs);
+        }
+    }
+
+    if (rebuilding) { // 输入已结束，丢弃尚未用上的新表
+#ifdef _WIN32
+        WaitForSingleObject(worker, INFINITE);
+        CloseHandle(worker);
+#else
+        pthread_join(worker, NULL);
+#endif
+        freeHuffmanCode(pending);
     }
-    Queue* q = createQueue();
-    enqueueHuffman(q, root, ' '); // 根节点没有位置标识
-    int currentLevelCount = 1;
-    int nextLevelCount = 0;
-    while (!isQueueEmpty(q)) {
-        QueueNode* current = dequeue(q);
-        currentLevelCount--;
-        HuffmanNode* huffNode = (HuffmanNode*)current->node;
-        // 输出当前节点信息
-        if (huffNode->cityCode != '\0') {
-            printf("%c%c ", huffNode->cityCode, current->position);
+    if (segLines > 0) {
+        writeLogSegment(fp, &w, segLines, code);
+        segments++;
+    }
+    long long outBytes = ftell(fp);
+    int ok = fclose(fp) == 0;
+    if (ok)
+        fprintf(stderr, "[提示] %lld行, %d个不同城市名, %lld -> %lld 字节(%.1f%%), %d段, 换表%d次\n",
+                totalLines, dict.count, inBytes, outBytes, inBytes > 0 ? outBytes * 100.0 / inBytes : 0.0,
+                segments, swaps);
+    else
+        printf("[错误] 写入文件 %s 失败\n", outPath);
+    freeHuffmanCode(code);
+    free(w.buf);
+    free(text);
+    free(offs);
+    free(ids);
+    free(hist);
+    free(freq);
+    freeNameDict(&dict);
+    return ok ? 0 : -1;
+}
+
+// 解码一段码流（共inBytes字节，以8字节填充结尾），遇到转义符时读出原样的名字并加入字典
+// 读到填充区之后说明文件损坏，返回-1，正常返回0
+static int decodeLogSegment(const HuffmanCode* hc, const unsigned char* in, size_t inBytes, int numLines,
+                            NameDict* dict, FILE* out) {
+    const unsigned long long limit = (inBytes - 8) * 8ULL;
+    int esc = hc->numSymbols - 1;
+    unsigned long long pos = 0;
+    int len;
+    char* name = NULL;
+    int nameCap = 0;
+    for (int i = 0; i < numLines;) {
+        if (pos > limit) break;
+        unsigned long long bits = peekBits(in, pos);
+        const HuffmanDecodeEntry* e = &hc->table[bits >> (64 - HUFFMAN_TABLE_BITS)];
+        int syms[HUFFMAN_TABLE_SYMS], count = e->count;
+        if (count > 0) {
+            for (int k = 0; k < count; k++) syms[k] = e->symbols[k];
         } else {
-            printf("*%c ", current->position); // 内部节点用*表示
+            syms[0] = decodeLongSymbol(hc, bits, &len);
+            count = 1;
+        }
+        for (int k = 0; k < count && i < numLines; k++, i++) {
+            int sym = syms[k];
+            pos += hc->length[sym];
+            if (sym == esc) {
+                if (pos > limit) break;
+                unsigned long long nameLen = peekBits(in, pos) >> 32;
+                pos += 32;
+                if (nameLen > 0 && (pos > limit || nameLen - 1 > (limit - pos) / 8)) { // 名字长度超出码流
+                    pos = limit + 1;
+                    break;
+                }
+                int n = (int)nameLen;
+                if (n > nameCap) {
+                    nameCap = n;
+                    name = (char*)realloc(name, nameCap);
+                }
+                for (int b = 0; b < n; b++, pos += 8) name[b] = (char)(peekBits(in, pos) >> 56);
+                sym = internName(dict, name, n);
+                count = k + 1; // 表项中转义符之后的位是名字，不是码字
+            }
+            fwrite(dict->text + dict->start[sym], 1, dict->len[sym], out);
+            putc('\n', out);
+        }
+        if (pos > limit) break;
+    }
+    free(name);
+    return pos > limit ? -1 : 0;
+}
+
+// 解压流式压缩的查询日志，成功返回0
+int decompressLogStream(const char* inPath, const char* outPath) {
+    size_t size;
+    const char* data = mapFile(inPath, &size);
+    if (data == NULL) {
+        printf("[错误] 无法打开文件 %s\n", inPath);
+        return -1;
+    }
+    if (size < sizeof(LOG_STREAM_MAGIC) || memcmp(data, LOG_STREAM_MAGIC, sizeof(LOG_STREAM_MAGIC)) != 0) {
+        printf("[错误] %s 不是流式压缩的日志\n", inPath);
+        unmapFile(data, size);
+        return -1;
+    }
+    FILE* out = fopen(outPath, "wb");
+    if (out == NULL) {
+        printf("[错误] 无法写入文件 %s\n", outPath);
+        unmapFile(data, size);
+        return -1;
+    }
+    NameDict dict;
+    initNameDict(&dict);
+    size_t p = sizeof(LOG_STREAM_MAGIC);
+    int segments = 0, ok = 1;
+    long long lines = 0;
+    while (p < size) {
+        LogSegmentHeader sh;
+        if (size - p < sizeof(sh)) {
+            ok = 0;
+            break;
         }
-        if (huffNode->left != NULL) {
-            enqueueHuffman(q, huffNode->left, 'L');
-            nextLevelCount++;
+        memcpy(&sh, data + p, sizeof(sh));
+        p += sizeof(sh);
+        if (sh.numSymbols < 0 || sh.numSymbols > dict.count || sh.numLines < 0 || sh.streamBytes < 8 ||
+            size - p < (size_t)sh.numSymbols + 1 + (size_t)sh.streamBytes ||
+            sh.numLines > (sh.streamBytes - 8) * 8 ||
+            !huffmanLengthsValid((const unsigned char*)data + p, sh.numSymbols + 1)) {
+            ok = 0;
+            break;
         }
-        if (huffNode->right != NULL) {
-            enqueueHuffman(q, huffNode->right, 'R');
-            nextLevelCount++;
+        HuffmanCode* hc = huffmanCodeFromLengths((const unsigned char*)data + p, sh.numSymbols + 1);
+        p += sh.numSymbols + 1;
+        int rc = decodeLogSegment(hc, (const unsigned char*)data + p, (size_t)sh.streamBytes, sh.numLines, &dict, out);
+        p += (size_t)sh.streamBytes;
+        freeHuffmanCode(hc);
+        if (rc != 0) {
+            ok = 0;
+            break;
         }
-        free(current); 
-        // 当前层结束，换行
-        if (currentLevelCount == 0) {
-            printf("\n");
-            currentLevelCount = nextLevelCount;
-            nextLevelCount = 0;
+        segments++;
+        lines += sh.numLines;
+    }
+    if (fclose(out) != 0) ok = 0;
+    if (ok)
+        printf("[提示] 已解压%lld行（%d段）到 %s\n", lines, segments, outPath);
+    else
+        printf("[错误] %s 已损坏或写入 %s 失败\n", inPath, outPath);
+    freeNameDict(&dict);
+    unmapFile(data, size);
+    return ok ? 0 : -1;
+}
+
+// 查询日志压缩菜单
+void queryLogMenu() {
+    char inPath[260], outPath[260];
+    int op, maxLen = 0;
+    printf("\n---------- 查询日志压缩 ----------\n");
+    printf("1. 压缩（日志每行一个城市名）\n2. 解压\n");
+    printf("3. 流式压缩（按频率变化自动换编码表）\n4. 解压流式压缩的日志\n请选择: ");
+    if (!readerInt(stdinReader(), &op)) op = 0;
+    readerChar(stdinReader());
+    if (op < 1 || op > 4) {
+        printf("[错误] 无效选择\n");
+        return;
+    }
+    printf("请输入源文件路径: ");
+    readerLine(stdinReader(), inPath, sizeof(inPath));
+    inPath[strcspn(inPath, "\n")] = 0;
+    printf("请输入目标文件路径: ");
+    readerLine(stdinReader(), outPath, sizeof(outPath));
+    outPath[strcspn(outPath, "\n")] = 0;
+    if (op == 2 || op == 4) {
+        if (op == 2)
+            decompressQueryLog(inPath, outPath);
+        else
+            decompressLogStream(inPath, outPath);
+        return;
+    }
+    if (op == 3) {
+        double percent = 5;
+        printf("请输入触发换表的压缩率变差幅度（%%，如5）: ");
+        if (!readerDouble(stdinReader(), &percent)) percent = 5;
+        readerChar(stdinReader());
+        FILE* in = fopen(inPath, "rb");
+        if (in == NULL) {
+            printf("[错误] 无法打开文件 %s\n", inPath);
+            return;
         }
+        streamCompressLog(in, outPath, percent / 100);
+        fclose(in);
+        return;
+    }
+    printf("请输入码长上限（0表示不限，最大%d）: ", HUFFMAN_MAX_CODE_LEN);
+    if (!readerInt(stdinReader(), &maxLen)) maxLen = 0;
+    readerChar(stdinReader());
+    compressQueryLog(inPath, outPath, maxLen);
+}
+
+// 按层打印节点，换层时换行；ctx记录上一个节点所在的层
+static void printHuffmanNode(const void* node, char position, int level, void* ctx) {
+    const HuffmanNode* huffNode = (const HuffmanNode*)node;
+    int* lastLevel = (int*)ctx;
+    if (level != *lastLevel) {
+        printf("\n");
+        *lastLevel = level;
+    }
+    if (huffNode->symbol >= 0) {
+        printf("%c%c ", huffNode->symbol, position);
+    } else {
+        printf("*%c ", position); // 内部节点用*表示
+    }
+}
+
+// 层次遍历赫夫曼树
+void levelOrderTraversal_Hu(HuffmanNode* root) {
+    if (root == NULL) {
+        printf("树为空！\n");
+        return;
     }
-    free(q);
+    int lastLevel = 0;
+    levelOrderTraverse(root, offsetof(HuffmanNode, left), offsetof(HuffmanNode, right), 0,
+                       printHuffmanNode, &lastLevel);
+    printf("\n");
 }
 
 AVLNode* createAVLNode(int cityNumber){
     AVLNode* node = (AVLNode*)malloc(sizeof(AVLNode));
     node->cityNumber=cityNumber;
     node->height=1;
+    node->size=1;
     node->left=NULL;
     node->right=NULL;
     return node;
@@ -538,27 +3646,27 @@ int getBalanceFactor(AVLNode* node){
     return getHeight(node->left)-getHeight(node->right);
 }
 
+int getSize(AVLNode* node){
+    if(node==NULL)return 0;
+    return node->size;
+}
+
+//由孩子重新计算高度和子树大小
+void updateAVLNode(AVLNode* node){
+    int leftHeight = getHeight(node->left);
+    int rightHeight = getHeight(node->right);
+    node->height = (leftHeight>rightHeight ? leftHeight : rightHeight)+1;
+    node->size = getSize(node->left)+getSize(node->right)+1;
+}
+
 //左左情况 
 AVLNode* leftleft(AVLNode* node){
     AVLNode* temp = node->left;
     AVLNode* cemp = temp->right;
     temp->right = node;
     node->left = cemp; 
-    int leftHeight = getHeight(node->left);
-    int rightHeight = getHeight(node->right);
-    if(leftHeight>rightHeight){
-        node->height=leftHeight+1;
-    }else {
-        node->height=rightHeight+1;
-    }
-    
-    leftHeight = getHeight(temp->left);
-    rightHeight = getHeight(temp->right);
-    if(leftHeight>rightHeight){
-        temp->height=leftHeight+1;
-    }else {
-        temp->height=rightHeight+1;
-    }
+    updateAVLNode(node);
+    updateAVLNode(temp);
     return temp; 
 }
 
@@ -568,20 +3676,8 @@ AVLNode* rightright(AVLNode* node){
     AVLNode* cemp = temp->left;
     temp->left=node;
     node->right=cemp;
-    int leftHeight = getHeight(node->left);
-    int rightHeight = getHeight(node->right);
-    if(leftHeight>rightHeight){
-        node->height=leftHeight+1;
-    }else {
-        node->height=rightHeight+1;
-    }
-    leftHeight = getHeight(temp->left);
-    rightHeight = getHeight(temp->right);
-    if(leftHeight>rightHeight){
-        temp->height=leftHeight+1;
-    }else {
-        temp->height=rightHeight+1;
-    }
+    updateAVLNode(node);
+    updateAVLNode(temp);
     return temp;
 } 
 
@@ -598,8 +3694,8 @@ AVLNode* AVLinsert(AVLNode* node,int cityNumber){
     } else {
         return node; // 重复值不插入
     }
-      // 更新高度
-    node->height = 1 + (getHeight(node->left) > getHeight(node->right) ? getHeight(node->left) : getHeight(node->right));
+      // 更新高度和子树大小
+    updateAVLNode(node);
     // 获取平衡因子
     int balance = getBalanceFactor(node);
     // 左左情况
@@ -623,47 +3719,228 @@ AVLNode* AVLinsert(AVLNode* node,int cityNumber){
     return node;
 } 
 
-void levelOrderTraversal_AVL(AVLNode* root){
-     if (root == NULL) {
-        printf("树为空！\n");
-        return;
+//失衡时按孩子的平衡因子选择单旋或双旋
+static AVLNode* rebalanceAVL(AVLNode* node){
+    updateAVLNode(node);
+    int balance = getBalanceFactor(node);
+    if (balance > 1) {
+        if (getBalanceFactor(node->left) < 0) node->left = rightright(node->left);
+        return leftleft(node);
+    }
+    if (balance < -1) {
+        if (getBalanceFactor(node->right) > 0) node->right = leftleft(node->right);
+        return rightright(node);
     }
+    return node;
+}
 
-    Queue* q = createQueue();
-    enqueueAVL(q, root, ' '); // 根节点没有位置标识
-    
-    int currentLevelCount = 1;
-    int nextLevelCount = 0;
+//AVL平衡树的删除 
+AVLNode* AVLdelete(AVLNode* node,int cityNumber){
+    if (node == NULL) return NULL;
+    if (cityNumber < node->cityNumber) {
+        node->left = AVLdelete(node->left, cityNumber);
+    } else if (cityNumber > node->cityNumber) {
+        node->right = AVLdelete(node->right, cityNumber);
+    } else if (node->left == NULL || node->right == NULL) {
+        AVLNode* child = node->left ? node->left : node->right;
+        free(node);
+        return child;
+    } else {
+        // 两个孩子：用右子树的最小值顶替，再从右子树删去它
+        AVLNode* succ = node->right;
+        while (succ->left != NULL) succ = succ->left;
+        node->cityNumber = succ->cityNumber;
+        node->right = AVLdelete(node->right, succ->cityNumber);
+    }
+    return rebalanceAVL(node);
+}
 
-    while (!isQueueEmpty(q)) {
-        QueueNode* current = dequeue(q);
-        currentLevelCount--;
-        
-        // 输出当前节点信息
-        AVLNode* avlNode = (AVLNode*)current->node;
-        printf("%d%c ", avlNode->cityNumber, current->position);
+AVLNode* AVLfind(AVLNode* root,int cityNumber){
+    while (root != NULL && root->cityNumber != cityNumber)
+        root = cityNumber < root->cityNumber ? root->left : root->right;
+    return root;
+}
 
-        // 将子节点加入队列并记录位置
-        if (avlNode->left != NULL) {
-            enqueueAVL(q, avlNode->left, 'L');
-            nextLevelCount++;
+//小于cityNumber的编号个数：向右走时累加左子树和当前节点
+int AVLrank(AVLNode* root,int cityNumber){
+    int rank = 0;
+    while (root != NULL) {
+        if (cityNumber <= root->cityNumber) {
+            root = root->left;
+        } else {
+            rank += getSize(root->left) + 1;
+            root = root->right;
         }
-        if (avlNode->right != NULL) {
-            enqueueAVL(q, avlNode->right, 'R');
-            nextLevelCount++;
+    }
+    return rank;
+}
+
+//第k小（从1开始），k越界返回NULL
+AVLNode* AVLselect(AVLNode* root,int k){
+    while (root != NULL) {
+        int leftSize = getSize(root->left);
+        if (k <= leftSize) {
+            root = root->left;
+        } else if (k == leftSize + 1) {
+            return root;
+        } else {
+            k -= leftSize + 1;
+            root = root->right;
         }
+    }
+    return NULL;
+}
+
+//落在[lo, hi]内的编号个数
+int AVLrangeCount(AVLNode* root,int lo,int hi){
+    if (lo > hi) return 0;
+    int upper = hi == INT_MAX ? getSize(root) : AVLrank(root, hi + 1);
+    return upper - AVLrank(root, lo);
+}
+
+static AVLNode* buildAVLRange(const int sorted[],int lo,int hi){
+    if (lo > hi) return NULL;
+    int mid = lo + (hi - lo) / 2;
+    AVLNode* node = createAVLNode(sorted[mid]);
+    node->left = buildAVLRange(sorted, lo, mid - 1);
+    node->right = buildAVLRange(sorted, mid + 1, hi);
+    updateAVLNode(node);
+    return node;
+}
+
+//由严格升序数组建树：每次取中点作根，左右两半的大小至多差一，天然满足AVL平衡，O(n)
+AVLNode* buildAVLFromSorted(const int sorted[],int n){
+    return buildAVLRange(sorted, 0, n - 1);
+}
+
+void AVLiteratorInit(AVLIterator* it,AVLNode* root){
+    it->stack = (AVLNode**)malloc((getHeight(root) + 1) * sizeof(AVLNode*));
+    it->top = 0;
+    for (; root != NULL; root = root->left) it->stack[it->top++] = root;
+}
+
+AVLNode* AVLiteratorNext(AVLIterator* it){
+    if (it->top == 0) return NULL;
+    AVLNode* node = it->stack[--it->top];
+    for (AVLNode* p = node->right; p != NULL; p = p->left) it->stack[it->top++] = p;
+    return node;
+}
+
+static int fillEytzinger(const int sorted[], int i, int* keys, int k, int n){
+    if (k <= n) {
+        i = fillEytzinger(sorted, i, keys, 2 * k, n);
+        keys[k] = sorted[i++];
+        i = fillEytzinger(sorted, i, keys, 2 * k + 1, n);
+    }
+    return i;
+}
 
-        free(current);
+// 中序遍历Eytzinger数组恰好是升序，所以按中序把sorted依次填进去即可；递归深度只有log n
+int freezeSortedIds(const int sorted[], int n, FrozenIdSet* set){
+    size_t bytes = ((size_t)(n + 1) * sizeof(int) + 63) & ~(size_t)63;
+#ifdef _WIN32
+    set->keys = (int*)_aligned_malloc(bytes, 64);
+#else
+    if (posix_memalign((void**)&set->keys, 64, bytes) != 0) set->keys = NULL;
+#endif
+    if (set->keys == NULL) {
+        set->n = 0;
+        return -1;
+    }
+    set->keys[0] = INT_MIN; // 所有元素都小于目标时下标回到0，INT_MIN不可能等于这样的目标
+    set->n = n;
+    fillEytzinger(sorted, 0, set->keys, 1, n);
+    set->fullLevels = 0;
+    while (((size_t)2 << set->fullLevels) - 1 <= (size_t)n) set->fullLevels++;
+    return 0;
+}
+
+int freezeAVL(AVLNode* root, FrozenIdSet* set){
+    int n = getSize(root);
+    int* sorted = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    AVLIterator it;
+    AVLNode* node;
+    int m = 0;
+    AVLiteratorInit(&it, root);
+    while ((node = AVLiteratorNext(&it)) != NULL) sorted[m++] = node->cityNumber;
+    free(it.stack);
+    int ret = freezeSortedIds(sorted, n, set);
+    free(sorted);
+    return ret;
+}
+
+void freeFrozenIdSet(FrozenIdSet* set){
+#ifdef _WIN32
+    _aligned_free(set->keys);
+#else
+    free(set->keys);
+#endif
+    set->keys = NULL;
+    set->n = 0;
+}
+
+// 向下走的每一步都是k=2k+(keys[k]<x)，没有分支；走出数组后末尾连续的1是最后几次右转，
+// 去掉它们再右移一位就回到第一个>=x的位置。keys+16k是四层之后的那一行，提前预取
+int frozenContains(const FrozenIdSet* set, int cityNumber){
+    const int* keys = set->keys;
+    size_t n = (size_t)set->n, k = 1;
+    if (n == 0) return 0;
+    while (k <= n) {
+        __builtin_prefetch(keys + 16 * k);
+        k = 2 * k + (keys[k] < cityNumber);
+    }
+    k >>= __builtin_ffsll(~(long long)k);
+    return keys[k] == cityNumber;
+}
 
-        // 当前层结束，换行
-        if (currentLevelCount == 0) {
-            printf("\n");
-            currentLevelCount = nextLevelCount;
-            nextLevelCount = 0;
+// 一组查询同时下降：同一层的FROZEN_BATCH次访存互不依赖，可以一起在途，掩盖缓存未命中。
+// 前fullLevels层一定存在，无条件走；最后一层可能不满，单独判断一次
+void frozenContainsBatch(const FrozenIdSet* set, const int ids[], int count, unsigned char found[]){
+    const int* keys = set->keys;
+    size_t n = (size_t)set->n;
+    size_t k[FROZEN_BATCH];
+    if (n == 0) {
+        memset(found, 0, count);
+        return;
+    }
+    for (int base = 0; base < count; base += FROZEN_BATCH) {
+        int m = count - base < FROZEN_BATCH ? count - base : FROZEN_BATCH;
+        const int* x = ids + base;
+        for (int j = 0; j < m; j++) k[j] = 1;
+        for (int level = 0; level < set->fullLevels; level++) {
+            for (int j = 0; j < m; j++) {
+                k[j] = 2 * k[j] + (keys[k[j]] < x[j]);
+                __builtin_prefetch(keys + 16 * k[j]);
+            }
+        }
+        for (int j = 0; j < m; j++) {
+            size_t kj = k[j];
+            if (kj <= n) kj = 2 * kj + (keys[kj] < x[j]);
+            kj >>= __builtin_ffsll(~(long long)kj);
+            found[base + j] = keys[kj] == x[j];
         }
     }
-    
-    free(q);
+}
+
+static void printAVLNode(const void* node, char position, int level, void* ctx){
+    int* lastLevel = (int*)ctx;
+    if (level != *lastLevel) {
+        printf("\n");
+        *lastLevel = level;
+    }
+    printf("%d%c ", ((const AVLNode*)node)->cityNumber, position);
+}
+
+void levelOrderTraversal_AVL(AVLNode* root){
+     if (root == NULL) {
+        printf("树为空！\n");
+        return;
+    }
+    // 最宽的一层不超过叶子数，即(size+1)/2
+    int lastLevel = 0;
+    levelOrderTraverse(root, offsetof(AVLNode, left), offsetof(AVLNode, right), (getSize(root) + 1) / 2,
+                       printAVLNode, &lastLevel);
+    printf("\n");
 }
 
 //AVL树排序 
@@ -672,88 +3949,191 @@ void AVLsort(){
     AVLNode* root = NULL;
     printf("\n-------城市名排序AVL树-------\n");
     printf("输入城市数：");
-    scanf("%d",&n);
-    int citynum[n+1];
-    getchar();
-    if(n<=0||n>30){
-        printf("请保证城市数量在1~30之间!");
+    if(!readerInt(stdinReader(),&n)||n<=0){
+        printf("请保证城市数量大于0!");
+        readerChar(stdinReader());
         return ;
     }
+    readerChar(stdinReader());
+    int* citynum = (int*)malloc(n*sizeof(int));
+    int sorted = 1;
     printf("输入各个城市编号：\n");
     for(int i=0;i<n;i++){
-        scanf("%d",&citynum[i]);
+        readerInt(stdinReader(),&citynum[i]);
+        if(i>0&&citynum[i]<citynum[i-1]) sorted = 0;
+    }
+    readerChar(stdinReader());
+    if(sorted){
+        // 已升序：去重后O(n)直接建平衡树，不需要逐个插入再旋转
+        int m = 0;
+        for(int i=0;i<n;i++)
+            if(m==0||citynum[i]!=citynum[m-1]) citynum[m++]=citynum[i];
+        root = buildAVLFromSorted(citynum,m);
+    }else{
+        for(int j=0;j<n;j++){
+            root = AVLinsert(root,citynum[j]); 
+        }
+    }
+    free(citynum);
+    if(getSize(root)<=PRINT_LIMIT){
+        printf("\n城市名AVL树层次遍历结果：\n");
+        levelOrderTraversal_AVL(root) ;
     }
-    for(int j=0;j<n;j++){
-        root = AVLinsert(root,citynum[j]); 
+    printf("\n排序结果（共%d个%s）：\n",getSize(root),getSize(root)>PRINT_LIMIT?"，只显示前面部分":"");
+    AVLIterator it;
+    AVLiteratorInit(&it,root);
+    AVLNode* node;
+    for(int k=0;k<PRINT_LIMIT&&(node=AVLiteratorNext(&it))!=NULL;k++) printf("%d ",node->cityNumber);
+    printf("\n");
+    free(it.stack);
+
+    FrozenIdSet frozen = {NULL, 0, 0}; // 只读查找用的冻结副本，删除后失效，下次批量查找时重建
+    while(1){
+        int op,a=0,b=0;
+        printf("\n1.查排名 2.第k小 3.区间计数 4.查找 5.删除 6.批量查找（从文件读编号） 0.返回\n请选择：");
+        if(!readerInt(stdinReader(),&op)||op==0) break;
+        if(op==1){
+            printf("输入城市编号：");
+            readerInt(stdinReader(),&a);
+            printf("比%d小的编号有%d个\n",a,AVLrank(root,a));
+        }else if(op==2){
+            printf("输入k：");
+            readerInt(stdinReader(),&a);
+            node = AVLselect(root,a);
+            if(node) printf("第%d小的编号是%d\n",a,node->cityNumber);
+            else printf("k应在1~%d之间\n",getSize(root));
+        }else if(op==3){
+            printf("输入区间下界和上界：");
+            readerInt(stdinReader(),&a);
+            readerInt(stdinReader(),&b);
+            printf("[%d, %d]内有%d个编号\n",a,b,AVLrangeCount(root,a,b));
+        }else if(op==4){
+            printf("输入城市编号：");
+            readerInt(stdinReader(),&a);
+            printf(AVLfind(root,a)?"%d存在\n":"%d不存在\n",a);
+        }else if(op==5){
+            printf("输入城市编号：");
+            readerInt(stdinReader(),&a);
+            int before = getSize(root);
+            root = AVLdelete(root,a);
+            printf(getSize(root)<before?"已删除%d\n":"%d不存在\n",a);
+            if(getSize(root)<before) freeFrozenIdSet(&frozen);
+        }else if(op==6){
+            char path[260];
+            printf("输入编号文件路径：");
+            if(!readerToken(stdinReader(),path,sizeof(path))) continue;
+            FastReader fr;
+            if(readerOpenFile(&fr,path)!=0){
+                printf("[错误] 无法打开文件 %s\n",path);
+                continue;
+            }
+            int cap = 1024, count = 0;
+            int* ids = (int*)malloc(cap*sizeof(int));
+            while(readerInt(&fr,&a)){
+                if(count==cap){
+                    cap *= 2;
+                    ids = (int*)realloc(ids,cap*sizeof(int));
+                }
+                ids[count++] = a;
+            }
+            readerClose(&fr);
+            if(frozen.keys==NULL&&freezeAVL(root,&frozen)!=0){
+                printf("[错误] 内存不足，无法冻结\n");
+                free(ids);
+                continue;
+            }
+            unsigned char* found = (unsigned char*)malloc(count>0?count:1);
+            clock_t t0 = clock();
+            int treeHits = 0;
+            for(int i=0;i<count;i++) treeHits += AVLfind(root,ids[i])!=NULL;
+            double treeMs = (double)(clock()-t0)*1000.0/CLOCKS_PER_SEC;
+            t0 = clock();
+            frozenContainsBatch(&frozen,ids,count,found);
+            double frozenMs = (double)(clock()-t0)*1000.0/CLOCKS_PER_SEC;
+            int hits = 0;
+            for(int i=0;i<count;i++) hits += found[i];
+            printf("共%d个编号，存在%d个\n",count,hits);
+            if(hits!=treeHits) printf("[错误] 冻结集合与AVL树结果不一致（%d/%d）\n",hits,treeHits);
+            printf("AVL树查找 %.2f ms，冻结数组批量查找 %.2f ms\n",treeMs,frozenMs);
+            free(found);
+            free(ids);
+        }
     }
-    printf("\n城市名AVL树层次遍历结果：\n");
-    levelOrderTraversal_AVL(root) ;
+    readerChar(stdinReader());
+    freeFrozenIdSet(&frozen);
     freeAVLTree(root);
 } 
+ 
 
+// 迭代释放：有左孩子时右旋把它提上来，没有时释放根并转到右子树，不需要栈也不会递归过深
 void freeAVLTree(AVLNode* root) {
-    if (root == NULL) return;
-    freeAVLTree(root->left);
-    freeAVLTree(root->right);
-    free(root);
+    while (root != NULL) {
+        if (root->left != NULL) {
+            AVLNode* left = root->left;
+            root->left = left->right;
+            left->right = root;
+            root = left;
+        } else {
+            AVLNode* right = root->right;
+            free(root);
+            root = right;
+        }
+    }
 }
 
-// 创建队列
-Queue* createQueue() {
-    Queue* q = (Queue*)malloc(sizeof(Queue));
-    q->front = q->rear = NULL;
-    return q;
+// 保证队列至少能放下cap项（按2的幂取整），扩容时把环绕的内容摆正
+static void ringReserve(RingQueue* q, int cap) {
+    if (cap <= q->cap) return;
+    int newCap = q->cap > 0 ? q->cap : 64;
+    while (newCap < cap) newCap *= 2;
+    LevelItem* items = (LevelItem*)malloc(newCap * sizeof(LevelItem));
+    STATS_ADD(STAT_RING_ALLOC, 1);
+    STATS_ADD(STAT_RING_BYTES, newCap * sizeof(LevelItem));
+    for (int i = 0; i < q->count; i++) items[i] = q->items[(q->head + i) & (q->cap - 1)];
+    free(q->items);
+    q->items = items;
+    q->cap = newCap;
+    q->head = 0;
 }
 
-//哈夫曼树入队（修改为包含位置信息）
-void enqueueHuffman(Queue* q, HuffmanNode* node, char pos) {
-    QueueNode* newNode = (QueueNode*)malloc(sizeof(QueueNode));
-    newNode->node = node;
-    newNode->position = pos;
-    newNode->next = NULL;
-    
-    if (q->rear == NULL) {
-        q->front = q->rear = newNode;
-    } else {
-        q->rear->next = newNode;
-        q->rear = newNode;
-    }
+static inline void ringPush(RingQueue* q, const void* node, char position) {
+    if (q->count == q->cap) ringReserve(q, q->count + 1);
+    LevelItem* item = &q->items[(q->head + q->count++) & (q->cap - 1)];
+    item->node = node;
+    item->position = position;
 }
 
-//AVL树入队
-void enqueueAVL(Queue* q,AVLNode* node,char pos){
-    QueueNode* newNode = (QueueNode*)malloc(sizeof(QueueNode));
-    newNode->node = node;
-    newNode->position = pos;
-    newNode->isAVL = 1;
-    newNode->next = NULL;
-    
-    if (q->rear == NULL) {
-        q->front = q->rear = newNode;
-    } else {
-        q->rear->next = newNode;
-        q->rear = newNode;
-    }
-} 
+static inline LevelItem ringPop(RingQueue* q) {
+    LevelItem item = q->items[q->head];
+    q->head = (q->head + 1) & (q->cap - 1);
+    q->count--;
+    return item;
+}
 
-// 出队（返回队列节点）
-QueueNode* dequeue(Queue* q) {
-    if (q->front == NULL) return NULL;
-    
-    QueueNode* temp = q->front;
-    q->front = q->front->next;
-    
-    if (q->front == NULL) {
-        q->rear = NULL;
+// 通用层次遍历：左右孩子指针位于节点的leftOffset、rightOffset处，每个节点调用一次visit
+// 队列按widthHint（树的最大层宽，未知时给0）预留并复用全局的levelQueue，预留足够时遍历中不再分配内存
+void levelOrderTraverse(const void* root, size_t leftOffset, size_t rightOffset, int widthHint,
+                        LevelVisitor visit, void* ctx) {
+    if (root == NULL) return;
+    RingQueue* q = &levelQueue;
+    ringReserve(q, widthHint);
+    q->head = q->count = 0;
+    ringPush(q, root, ' ');
+    int level = 0, levelLeft = 1;
+    while (q->count > 0) {
+        LevelItem cur = ringPop(q);
+        visit(cur.node, cur.position, level, ctx);
+        const void* left = *(const void* const*)((const char*)cur.node + leftOffset);
+        const void* right = *(const void* const*)((const char*)cur.node + rightOffset);
+        if (left != NULL) ringPush(q, left, 'L');
+        if (right != NULL) ringPush(q, right, 'R');
+        if (--levelLeft == 0) { // 当前层结束
+            level++;
+            levelLeft = q->count;
+        }
     }
-    
-    return temp;
 }
 
-// 判断队列是否为空
-int isQueueEmpty(Queue* q) {
-    return q->front == NULL;
-}
 
 // 显示当前已创建的城市列表
 void showCityList() {
@@ -761,17 +4141,42 @@ void showCityList() {
         printf("[无城市信息]\n");
         return;
     }
+    int n = graph.numCities < PRINT_LIMIT ? graph.numCities : PRINT_LIMIT;
     printf("[城市列表]: ");
-    for (int i = 0; i < graph.numCities; i++) {
-        printf("%s", graph.cities[i].name);
-        if (i < graph.numCities - 1) printf(", ");
+    for (int i = 0; i < n; i++) {
+        printf("%s", cityName(i));
+        if (i < n - 1) printf(", ");
     }
+    if (n < graph.numCities) printf(" ...等%d个城市", graph.numCities);
     printf("\n");
 }
 
-// 主函数
-int main() {
+// 基准测试等直接包含本文件时定义NO_MAIN，只用其中的函数
+#ifndef NO_MAIN
+// 主函数，可在命令行指定要加载的路网文件，以及非交互的批量查询：
+//   citynetworkRoad 地图文件 --batch 查询文件 [结果文件]
+//   citynetworkRoad 地图文件 --serve 套接字路径
+//   citynetworkRoad 地图文件 --save-snapshot 快照文件
+// 地图文件可以是CSV、DIMACS .gr或快照
+int main(int argc, char* argv[]) {
     int choice;
+    statsInit();
+    if (argc > 3 && strcmp(argv[1], "--compress-log") == 0)
+        return compressQueryLog(argv[2], argv[3], argc > 4 ? atoi(argv[4]) : 0) == 0 ? 0 : 1;
+    if (argc > 3 && strcmp(argv[1], "--decompress-log") == 0)
+        return decompressQueryLog(argv[2], argv[3]) == 0 ? 0 : 1;
+    if (argc > 2 && strcmp(argv[1], "--stream-log") == 0) // 从标准输入持续读取日志
+        return streamCompressLog(stdin, argv[2], argc > 3 ? atof(argv[3]) / 100 : 0.05) == 0 ? 0 : 1;
+    if (argc > 3 && strcmp(argv[1], "--decompress-stream") == 0)
+        return decompressLogStream(argv[2], argv[3]) == 0 ? 0 : 1;
+    if (argc > 1 && loadGraphFile(argv[1]) != 0 && argc > 2)
+        return 1;
+    if (argc > 3 && strcmp(argv[2], "--batch") == 0)
+        return batchQueryFile(argv[3], argc > 4 ? argv[4] : NULL) == 0 ? 0 : 1;
+    if (argc > 3 && strcmp(argv[2], "--serve") == 0)
+        return serveBatchSocket(argv[3]) == 0 ? 0 : 1;
+    if (argc > 3 && strcmp(argv[2], "--save-snapshot") == 0)
+        return saveSnapshot(argv[3]) == 0 ? 0 : 1;
     while (1) {
         printf("\n====================================\n");
         printf("      城市交通网络系统 主菜单      \n");
@@ -782,11 +4187,19 @@ int main() {
         printf("4. 城市名查询赫夫曼树\n");
         printf("5. 城市名排序（AVL树）\n");
         printf("6. 显示地图可视化\n");
-        printf("7. 退出\n");
+        printf("7. 可达性分析（BFS）\n");
+        printf("8. 加载路网文件（CSV/DIMACS）\n");
+        printf("9. 路线缓存统计\n");
+        printf("10. 修改/删除道路\n");
+        printf("11. 批量路线查询\n");
+        printf("12. 保存地图快照\n");
+        printf("13. 查询日志压缩（赫夫曼编码）\n");
+        printf("14. 运行统计\n");
+        printf("15. 退出\n");
         printf("------------------------------------\n");
-        printf("请输入功能编号(1-7): ");
-        scanf("%d", &choice);
-        getchar(); // 消耗换行符
+        printf("请输入功能编号(1-15): ");
+        if (!readerInt(stdinReader(), &choice)) choice = 15; // 输入结束时退出
+        readerChar(stdinReader()); // 消耗换行符
 
         switch (choice) {
             case 1:
@@ -814,6 +4227,43 @@ int main() {
                 visualizeMap();
                 break;
             case 7:
+                if (graphCreated)
+                    reachabilityAnalysis();
+                else
+                    printf("[提示] 请先创建地图！\n");
+                break;
+            case 8:
+                loadGraphMenu();
+                break;
+            case 9:
+                pathCacheMenu();
+                break;
+            case 10:
+                if (graphCreated)
+                    updateRoadMenu();
+                else
+                    printf("[提示] 请先创建地图！\n");
+                break;
+            case 11:
+                if (graphCreated)
+                    batchQueryMenu();
+                else
+                    printf("[提示] 请先创建地图！\n");
+                break;
+            case 12:
+                if (graphCreated)
+                    snapshotMenu();
+                else
+                    printf("[提示] 请先创建地图！\n");
+                break;
+            case 13:
+                queryLogMenu();
+                break;
+            case 14:
+                printf("\n---------- 运行统计 ----------\n");
+                statsReport(stdout);
+                break;
+            case 15:
                 printf("程序退出！\n");
                 exit(0);
             default:
@@ -821,4 +4271,5 @@ int main() {
         }
     }
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -1,8 +1,11 @@
 #include <iostream>
+#include "../common/fastreader.h"
 using namespace std;
 int main() {
-    int i, j;
-    cin >> i >> j;
+    int i = 0, j = 0;
+    FastReader* in = stdinReader();
+    readerInt(in, &i);
+    readerInt(in, &j);
     int n = i + j;
     cout << n << endl;
     cout << "Hello, World!" << endl;
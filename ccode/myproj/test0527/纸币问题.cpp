@@ -1,13 +1,633 @@
 #include<bits/stdc++.h>
+#include"../common/fastreader.h"
+#if defined(__GNUC__)&&(defined(__x86_64__)||defined(__i386__))
+#include<immintrin.h>
+#define HAVE_AVX2_KERNEL
+#endif
 using namespace std;
-long long n,w,a[1010],f[100010];
-int main(){
-	cin>>n>>w;
-	for(int i=1;i<=n;i++)cin>>a[i];
-	for(int i=1;i<=10010;i++)f[i]=1145141919;
-	for(int i=1;i<=n;i++)
-		for(int j=a[i];j<=w;j++)
-			f[j]=min(f[j],f[j-a[i]]+1);
-	cout<<f[w]<<endl;
+const long long NONE=1145141919;//凑不出时输出的值
+const long long BLOCK=1<<16;//分块长度：一块f留在缓存里，所有面额都更新完再换下一块
+const unsigned MOD=998244353;//计数模式的模数，998244353=119*2^23+1，原根3，NTT长度最多2^23
+const long long WAYS_DP_MAX=1500;//面额种数不超过它时直接DP求方案数：多项式exp常数大，实测上千种面额才追平
+const long long SPLIT_MAX=7;//有限张数不超过它时拆成1,2,4做0/1背包，三遍扫描比单调队列便宜
+#ifdef HAVE_AVX2_KERNEL
+static const bool useAVX2=__builtin_cpu_supports("avx2");
+#else
+static const bool useAVX2=false;
+#endif
+
+//输入都是整数，走共用的快速读取器
+bool readLL(long long&x){return readerLongLong(stdinReader(),&x);}
+
+//f[j]=min(f[j],f[j-a]+1)，j在[lo,hi)，类型最大值表示凑不出；p非空时记下让f[j]变小的面额下标idx
+template<class T> void relaxScalar(T*f,T*p,T idx,long long lo,long long hi,long long a){
+	const T INF=numeric_limits<T>::max();
+	if(p!=nullptr){
+		for(long long j=lo;j<hi;j++)
+			if(f[j-a]!=INF&&f[j-a]+1<f[j]){
+				f[j]=f[j-a]+1;
+				p[j]=idx;
+			}
+		return;
+	}
+	if(a==1){//相邻依赖：上一个值留在寄存器里，不必等它写回内存再读出来
+		T prev=f[lo-1];
+		for(long long j=lo;j<hi;j++)prev=f[j]=min(f[j],(T)(prev+(prev!=INF)));
+		return;
+	}
+	for(long long j=lo;j<hi;j++){
+		T v=f[j-a]+(f[j-a]!=INF);//不写成分支：能否变小几乎是随机的，分支预测不准
+		f[j]=min(f[j],v);
+	}
+}
+
+#ifdef HAVE_AVX2_KERNEL
+#define AVX2_INLINE __attribute__((target("avx2"),always_inline)) inline
+AVX2_INLINE __m256i splat(uint8_t v){return _mm256_set1_epi8((char)v);}
+AVX2_INLINE __m256i splat(uint16_t v){return _mm256_set1_epi16((short)v);}
+AVX2_INLINE __m256i splat(uint32_t v){return _mm256_set1_epi32((int)v);}
+AVX2_INLINE __m256i vmin(__m256i x,__m256i y,uint8_t){return _mm256_min_epu8(x,y);}
+AVX2_INLINE __m256i vmin(__m256i x,__m256i y,uint16_t){return _mm256_min_epu16(x,y);}
+AVX2_INLINE __m256i vmin(__m256i x,__m256i y,uint32_t){return _mm256_min_epu32(x,y);}
+AVX2_INLINE __m256i veq(__m256i x,__m256i y,uint8_t){return _mm256_cmpeq_epi8(x,y);}
+AVX2_INLINE __m256i veq(__m256i x,__m256i y,uint16_t){return _mm256_cmpeq_epi16(x,y);}
+AVX2_INLINE __m256i veq(__m256i x,__m256i y,uint32_t){return _mm256_cmpeq_epi32(x,y);}
+//加一并在INF处饱和；32位没有饱和加法，INF加一回绕成0，用比较结果把这些位置重新置为INF
+AVX2_INLINE __m256i incSat(__m256i y,uint8_t){return _mm256_adds_epu8(y,_mm256_set1_epi8(1));}
+AVX2_INLINE __m256i incSat(__m256i y,uint16_t){return _mm256_adds_epu16(y,_mm256_set1_epi16(1));}
+AVX2_INLINE __m256i incSat(__m256i y,uint32_t){
+	return _mm256_or_si256(_mm256_add_epi32(y,_mm256_set1_epi32(1)),_mm256_cmpeq_epi32(y,_mm256_set1_epi32(-1)));
+}
+
+//a不小于向量宽度时，f[j..j+V)只依赖本轮已经算完的f[j-a..j-a+V)，整条向量一起更新；
+//p与f同宽，没有变小的位置（min等于原值）保留原来的下标。返回向量部分停下的位置，剩下的交给标量
+template<class T> __attribute__((target("avx2"))) long long relaxVector(T*f,T*p,T idx,long long lo,long long hi,long long a){
+	const long long V=32/sizeof(T);
+	long long j=lo;
+	if(p==nullptr){
+		for(;j+V<=hi;j+=V){
+			__m256i x=_mm256_loadu_si256((const __m256i*)(f+j)),y=_mm256_loadu_si256((const __m256i*)(f+j-a));
+			_mm256_storeu_si256((__m256i*)(f+j),vmin(x,incSat(y,T()),T()));
+		}
+		return j;
+	}
+	const __m256i id=splat(idx);
+	for(;j+V<=hi;j+=V){
+		__m256i x=_mm256_loadu_si256((const __m256i*)(f+j)),y=_mm256_loadu_si256((const __m256i*)(f+j-a));
+		__m256i m=vmin(x,incSat(y,T()),T());
+		__m256i old=_mm256_loadu_si256((const __m256i*)(p+j));
+		_mm256_storeu_si256((__m256i*)(f+j),m);
+		_mm256_storeu_si256((__m256i*)(p+j),_mm256_blendv_epi8(id,old,veq(m,x,T())));
+	}
+	return j;
+}
+#else
+template<class T> long long relaxVector(T*,T*,T,long long lo,long long,long long){return lo;}
+#endif
+long long relaxVector(uint64_t*,uint64_t*,uint64_t,long long lo,long long,long long){return lo;}
+
+//完全背包求最少张数，填f[from..w]（更小的下标已经是终值）。按j分块、块内逐个面额更新：
+//凑出j的最优方案按面额下标排好序，最后一张所在的面额处理到j时，前面的部分要么在更早的块里已经是终值，
+//要么在本块里已经处理过，结果与先枚举面额的写法相同。p非空时同时记录父指针：p[j]是最后一张的面额下标
+template<class T> void fillTable(T*f,T*p,const vector<long long>&a,long long from,long long w){
+	const long long V=32/sizeof(T);
+	for(long long J=from;J<=w;J+=BLOCK){
+		long long hi=min(J+BLOCK,w+1);
+		for(size_t i=0;i<a.size();i++){
+			long long c=a[i],lo=max(J,c);
+			if(lo>=hi)continue;
+			if(useAVX2&&c>=V)lo=relaxVector(f,p,(T)i,lo,hi,c);
+			relaxScalar(f,p,(T)i,lo,hi,c);
+		}
+	}
+}
+
+//波前并行用的松弛：读的f[j-a]可能在别的线程正在写的块里，自己写的f[j]也会被后面的块同时读，
+//所以跨线程可见的读写都用relaxed原子操作（x86上仍是普通的mov，只是不能再用向量指令）。f[j]只有本线程写，直接读
+template<class T> void relaxShared(T*f,long long lo,long long hi,long long a){
+	const T INF=numeric_limits<T>::max();
+	for(long long j=lo;j<hi;j++){
+		T u=__atomic_load_n(f+j-a,__ATOMIC_RELAXED),v=u+(u!=INF);
+		__atomic_store_n(f+j,min(f[j],v),__ATOMIC_RELAXED);
+	}
+}
+
+//多线程波前：f切成BLOCK长的块，块b归线程b%threads。线程按块的顺序、块内按面额顺序处理，
+//做(块b,面额i)之前等块b-1做完面额i：j-a_i落在前面的块里，而块b-1也等过块b-2，所以更早的块都已做完面额i。
+//相邻块错开一个面额像流水线一样推进，同时在算的块数最多是面额种数。
+//前面的块可能已经跑到了后面的面额，读到的值只会更小且仍然凑得出，所以每项仍不大于顺序做法的中间值，终值相同；
+//这些读和前面块的写同时发生，都走relaxShared的原子读写，done的acquire/release保证至少读到做完面额i时的值
+template<class T> void fillTableParallel(T*f,const vector<long long>&a,long long w,int threads){
+	const long long nb=(w+BLOCK-1)/BLOCK;
+	vector<atomic<int>>done(nb);
+	for(auto&d:done)d.store(0);
+	auto work=[&](int id){
+		for(long long b=id;b<nb;b+=threads){
+			long long J=1+b*BLOCK,hi=min(J+BLOCK,w+1);
+			for(size_t i=0;i<a.size();i++){
+				if(b>0)while(done[b-1].load(memory_order_acquire)<=(int)i)this_thread::yield();
+				long long c=a[i],lo=max(J,c);
+				if(lo<hi)relaxShared(f,lo,hi,c);
+				done[b].store(i+1,memory_order_release);
+			}
+		}
+	};
+	vector<thread>pool;
+	for(int t=1;t<threads;t++)pool.emplace_back(work,t);
+	work(0);
+	for(auto&th:pool)th.join();
+}
+
+template<class T> long long minNotes(const vector<long long>&a,long long w,int threads){
+	vector<T>f(w+1,numeric_limits<T>::max());
+	f[0]=0;
+	if(threads>1)fillTableParallel(f.data(),a,w,threads);
+	else fillTable(f.data(),(T*)nullptr,a,1,w);
+	return f[w]==numeric_limits<T>::max()?NONE:f[w];
+}
+
+//从j开始连续拿k张面额c仍然最优，当且仅当f[j-k*c]==f[j]-k；满足的k是从0开始的一段
+//（f[j-k'c]夹在f[j]-k'和f[j-kc]+(k-k')之间），倍增再二分求出最大的k，还原时一种面额只走O(log)步
+template<class T> long long takeRun(const T*f,long long j,long long c){
+	auto ok=[&](long long k){return k*c<=j&&(long long)f[j-k*c]==(long long)f[j]-k;};
+	long long lo=1,hi=2;//ok(lo)成立（p[j]就是这样选出来的）
+	while(ok(hi)){
+		lo=hi;
+		hi*=2;
+	}
+	while(hi-lo>1){
+		long long mid=(lo+hi)/2;
+		if(ok(mid))lo=mid;
+		else hi=mid;
+	}
+	return lo;
+}
+
+//批量模式：读完所有金额后只建一次表（到最大金额），再沿父指针还原每个金额用了哪些纸币
+//输出每行：张数 面额*张数 ...（面额从大到小），凑不出时只输出NONE
+template<class T> void answerBatch(const vector<long long>&a,const vector<long long>&q,long long w){
+	const T INF=numeric_limits<T>::max();
+	vector<T>f(w+1,INF),p(w+1);
+	f[0]=0;
+	fillTable(f.data(),p.data(),a,1,w);
+	vector<long long>used(a.size());
+	string out;
+	for(long long x:q){
+		if(x<0||f[x]==INF){
+			out+=to_string(NONE)+"\n";
+			continue;
+		}
+		out+=to_string((long long)f[x]);
+		for(long long j=x;j>0;){
+			long long i=p[j],c=a[i],k=takeRun(f.data(),j,c);
+			used[i]+=k;
+			j-=k*c;
+		}
+		for(size_t i=a.size();i-->0;)
+			if(used[i]){
+				out+=" "+to_string(a[i])+"*"+to_string(used[i]);
+				used[i]=0;
+			}
+		out+="\n";
+		if(out.size()>(1<<16)){
+			cout<<out;
+			out.clear();
+		}
+	}
+	cout<<out;
+}
+
+//答案不超过w/最小面额，选能放下它（再留一个INF）的最窄类型，窄一半带宽就省一半
+int pickWidth(long long most){
+	if(most<UINT8_MAX)return 8;
+	if(most<UINT16_MAX)return 16;
+	if(most<(long long)UINT32_MAX)return 32;
+	return 64;
+}
+
+void readNotes(long long n,vector<long long>&a){
+	for(long long i=0,x;i<n&&readLL(x);i++)
+		if(x>0)a.push_back(x);
+	sort(a.begin(),a.end());
+	a.erase(unique(a.begin(),a.end()),a.end());
+}
+
+//输入：面额种数n，n个面额，之后是任意多个金额，直到输入结束
+void batchMode(){
+	long long n=0,x;
+	vector<long long>a,q;
+	readLL(n);
+	readNotes(n,a);
+	long long w=0;
+	while(readLL(x)){
+		q.push_back(x);
+		w=max(w,x);
+	}
+	while(!a.empty()&&a.back()>w)a.pop_back();//比最大金额还大的面额用不上
+	//父指针与f同宽，所以类型还要放得下面额下标
+	long long most=max(a.empty()?0:w/a[0],(long long)a.size());
+	switch(pickWidth(most)){
+		case 8:answerBatch<uint8_t>(a,q,w);break;
+		case 16:answerBatch<uint16_t>(a,q,w);break;
+		case 32:answerBatch<uint32_t>(a,q,w);break;
+		default:answerBatch<uint64_t>(a,q,w);break;
+	}
+}
+
+//0/1背包：一件物品面值d、计m张，从大到小扫描保证每件只用一次
+template<class T> void addItem(T*f,long long w,long long d,long long m){
+	const T INF=numeric_limits<T>::max();
+	for(long long j=w;j>=d;j--)
+		if(f[j-d]!=INF&&f[j-d]+m<f[j])f[j]=f[j-d]+m;
+}
+
+//面额c最多用k张：按j模c分类，类内第t项g[t]=f[r+t*c]，新值为 min_{t-k<=s<=t} (g[s]-s) + t，
+//用单调队列维护窗口最小值，每个j进出队列各一次，总共O(w)。队列里不会超过k+1项，每个余数一个环形缓冲。
+//一次处理一整条缓存行上的L个余数，沿t前进时每步访问的是连续的L个元素，而不是每个余数各跨步扫一遍
+template<class T> void addBounded(T*f,long long w,long long c,long long k){
+	const T INF=numeric_limits<T>::max();
+	const long long L=64/sizeof(T);
+	long long cap=1;
+	while(cap<min(k+1,w/c+1))cap*=2;
+	const long long mask=cap-1;
+	vector<long long>qi(L*cap),qv(L*cap);
+	long long head[64],tail[64];
+	for(long long r0=0;r0<c&&r0<=w;r0+=L){
+		long long lanes=min(L,c-r0);
+		for(long long l=0;l<lanes;l++)head[l]=tail[l]=0;
+		for(long long t=0,base=r0;base<=w;t++,base+=c){
+			for(long long l=0;l<lanes&&base+l<=w;l++){
+				long long j=base+l,*id=qi.data()+l*cap,*val=qv.data()+l*cap;
+				while(head[l]<tail[l]&&id[head[l]&mask]<t-k)head[l]++;//先出队再入队，队长才不超过k+1
+				if(f[j]!=INF){
+					long long v=(long long)f[j]-t;
+					while(tail[l]>head[l]&&val[(tail[l]-1)&mask]>=v)tail[l]--;
+					id[tail[l]&mask]=t;
+					val[tail[l]++&mask]=v;
+				}
+				if(head[l]<tail[l])f[j]=(T)(val[head[l]&mask]+t);
+			}
+		}
+	}
+}
+
+//有限库存：每种面额(c,k)按张数选做法。k*c>=w等于不限量，走向量化的完全背包；
+//k很小时二进制拆分成几件0/1物品；其余用单调队列
+template<class T> long long minNotesBounded(const vector<pair<long long,long long>>&notes,long long w){
+	vector<T>f(w+1,numeric_limits<T>::max());
+	f[0]=0;
+	for(auto&nk:notes){
+		long long c=nk.first,k=nk.second;
+		if(k>=w/c)fillTable(f.data(),(T*)nullptr,vector<long long>{c},1,w);
+		else if(k<=SPLIT_MAX){
+			for(long long m=1;k>0;m*=2){
+				long long take=min(m,k);
+				addItem(f.data(),w,take*c,take);
+				k-=take;
+			}
+		}else addBounded(f.data(),w,c,k);
+	}
+	return f[w]==numeric_limits<T>::max()?NONE:f[w];
+}
+
+//输入：n w，之后n对“面额 张数”
+void boundedMode(){
+	long long n=0,w=0;
+	readLL(n);
+	readLL(w);
+	map<long long,long long>cnt;//同一面额出现多次时张数相加
+	for(long long i=0,c,k;i<n&&readLL(c)&&readLL(k);i++)
+		if(c>0&&c<=w&&k>0)cnt[c]+=k;
+	if(w<0){
+		cout<<NONE<<endl;
+		return;
+	}
+	vector<pair<long long,long long>>notes(cnt.begin(),cnt.end());
+	long long most=notes.empty()?0:w/notes[0].first;
+	long long ans;
+	switch(pickWidth(most)){
+		case 8:ans=minNotesBounded<uint8_t>(notes,w);break;
+		case 16:ans=minNotesBounded<uint16_t>(notes,w);break;
+		case 32:ans=minNotesBounded<uint32_t>(notes,w);break;
+		default:ans=minNotesBounded<uint64_t>(notes,w);break;
+	}
+	cout<<ans<<endl;
+}
+
+//对最大面额m取余：w=Σx_i*a_i+y*m时张数为(Σx_i*(m-a_i)+w)/m，所以最少张数只取决于余数r=w mod m上的最短路：
+//结点是余数，加一张a_i就是r->(r+a_i)%m、边权m-a_i（非负；对最小面额取余会出现负权）。
+//cost[r]是最短路长度，sum[r]是这条路上的金额Σx_i*a_i（同样长时取小的）；w>=sum[r]时y非负，答案就是(cost[r]+w)/m
+struct ResidueTable{
+	long long m;
+	vector<long long>cost,sum;
+};
+
+//按面额逐个做round-robin松弛：余数按加a_i分成gcd(a_i,m)个环，环上当前最小的结点已是终值，
+//从它出发绕一圈就得到加入a_i后的结果。总共O(n*m)，与w无关
+void buildResidueTable(const vector<long long>&a,ResidueTable&t){
+	const long long INF=LLONG_MAX;
+	long long m=t.m=a.back();
+	t.cost.assign(m,INF);
+	t.sum.assign(m,INF);
+	t.cost[0]=t.sum[0]=0;
+	auto less=[&](long long c1,long long s1,long long r){return c1<t.cost[r]||(c1==t.cost[r]&&s1<t.sum[r]);};
+	for(long long c:a){
+		if(c==m)continue;
+		long long g=__gcd(c,m),len=m/g;
+		for(long long s=0;s<g;s++){
+			long long best=s;
+			for(long long k=1,r=(s+c)%m;k<len;k++,r=(r+c)%m)
+				if(t.cost[r]!=INF&&less(t.cost[r],t.sum[r],best))best=r;
+			if(t.cost[best]==INF)continue;//整个环都还到不了
+			for(long long k=1,r=best;k<len;k++){
+				long long nx=(r+c)%m;
+				if(less(t.cost[r]+m-c,t.sum[r]+c,nx)){
+					t.cost[nx]=t.cost[r]+m-c;
+					t.sum[nx]=t.sum[r]+c;
+				}
+				r=nx;
+			}
+		}
+	}
+}
+
+//金额w小于sum[r]时余数r上的最短路用的钱太多，要在金额不超过w的路里找cost最小的。仍在余数图上走，
+//标号是(cost,sum)，按字典序从小到大出队：同一余数上后出队的标号cost不更小，只有sum更小才有用，
+//所以每个余数记下已出队的最小sum，不更小的就丢掉。标号出队时，这个余数上不小于它的sum、还没有答案的金额
+//就以它为最优。sum超过最大金额的标号不再扩展，占用的内存与标号数成正比，与金额大小无关
+void tailAnswers(const vector<long long>&a,const ResidueTable&t,const vector<long long>&q,vector<size_t>&idx,vector<long long>&ans){
+	const long long m=t.m;
+	long long tailMax=0;
+	for(size_t i:idx)tailMax=max(tailMax,q[i]);
+	//按余数分组，组内金额从大到小：sum越出越小，能回答的金额也从大到小
+	sort(idx.begin(),idx.end(),[&](size_t x,size_t y){return q[x]%m!=q[y]%m?q[x]%m<q[y]%m:q[x]>q[y];});
+	vector<size_t>next(m,idx.size());//余数r上下一个待回答的金额在idx里的位置
+	for(size_t k=idx.size();k-->0;)next[q[idx[k]]%m]=k;
+	vector<long long>minSum(m,LLONG_MAX);
+	typedef tuple<long long,long long,long long>Label;//(cost,sum,余数)
+	priority_queue<Label,vector<Label>,greater<Label>>pq;
+	pq.emplace(0,0,0);
+	size_t left=idx.size();
+	while(!pq.empty()&&left>0){
+		long long c=get<0>(pq.top()),s=get<1>(pq.top()),r=get<2>(pq.top());
+		pq.pop();
+		if(s>=minSum[r])continue;
+		minSum[r]=s;
+		for(size_t&k=next[r];k<idx.size()&&q[idx[k]]%m==r&&q[idx[k]]>=s;k++,left--)
+			ans[idx[k]]=(long long)(((__int128)c+q[idx[k]])/m);
+		for(long long x:a){
+			if(x==m||s+x>tailMax)break;//面额从小到大，最大的就是m
+			long long nr=(r+x)%m;
+			if(s+x<minSum[nr])pq.emplace(c+m-x,s+x,nr);
+		}
+	}
+}
+
+//超大金额：输入同批量模式，金额可到1e18。每个金额O(1)查余数表；
+//少数小于sum[r]的金额最优解里最大面额不够多，再在余数图上单独找（见tailAnswers）
+void hugeMode(){
+	long long n=0,x;
+	vector<long long>a,q;
+	readLL(n);
+	readNotes(n,a);
+	while(readLL(x))q.push_back(x);
+	vector<long long>ans(q.size(),NONE);
+	if(a.empty()){
+		for(size_t i=0;i<q.size();i++)if(q[i]==0)ans[i]=0;
+	}else{
+		ResidueTable t;
+		buildResidueTable(a,t);
+		vector<size_t>tail;
+		for(size_t i=0;i<q.size();i++){
+			if(q[i]<0)continue;
+			long long r=q[i]%t.m;
+			if(t.cost[r]==LLONG_MAX)continue;
+			if(q[i]>=t.sum[r])ans[i]=(long long)(((__int128)t.cost[r]+q[i])/t.m);
+			else tail.push_back(i);
+		}
+		if(!tail.empty())tailAnswers(a,t,q,tail,ans);//找不到的保持NONE
+	}
+	string out;
+	for(long long v:ans)out+=to_string(v)+"\n";
+	cout<<out;
+}
+
+unsigned long long power(unsigned long long b,unsigned long long e){
+	unsigned long long r=1;
+	for(b%=MOD;e;e>>=1,b=b*b%MOD)if(e&1)r=r*b%MOD;
+	return r;
+}
+
+//蒙哥马利约简：返回t/2^32 mod MOD。单位根预先乘上2^32存放，普通数乘它再约简就是普通的乘积，
+//蝶形里省掉一次64位取模
+constexpr unsigned montInv(){
+	unsigned x=MOD;
+	for(int i=0;i<5;i++)x*=2-MOD*x;
+	return 0u-x;
+}
+const unsigned MONT_NINV=montInv();//-MOD^-1 mod 2^32
+inline unsigned montMul(unsigned a,unsigned b){
+	unsigned long long t=(unsigned long long)a*b;
+	unsigned m=(unsigned)t*MONT_NINV;
+	unsigned r=(unsigned)((t+(unsigned long long)m*MOD)>>32);
+	return r>=MOD?r-MOD:r;
+}
+
+//rt[h+k]=ω^k*2^32，ω是2h次单位根（h取2的幂），irt对应逆元，按需扩展，各层蝶形顺序读取
+vector<unsigned>rt{0,(unsigned)((1ull<<32)%MOD)},irt{0,(unsigned)((1ull<<32)%MOD)};
+void ensureRoots(size_t n){
+	for(size_t h=rt.size();h<n;h*=2){
+		rt.resize(2*h);
+		irt.resize(2*h);
+		unsigned long long z=power(3,(MOD-1)/(2*h)),iz=power(z,MOD-2),r=1,ir=1;
+		for(size_t k=0;k<h;k++){
+			rt[h+k]=(unsigned)((r<<32)%MOD);
+			irt[h+k]=(unsigned)((ir<<32)%MOD);
+			r=r*z%MOD;
+			ir=ir*iz%MOD;
+		}
+	}
+}
+
+//正变换用频域抽取（自然序进、位逆序出），逆变换用时域抽取（位逆序进、自然序出），
+//卷积只在两者之间逐点相乘，位逆序的排列抵消掉了，不需要按位逆序交换
+void ntt(vector<unsigned>&a,bool invert){
+	size_t n=a.size();
+	ensureRoots(n);
+	if(!invert){
+		for(size_t h=n/2;h>=1;h/=2)
+			for(size_t i=0;i<n;i+=2*h)
+				for(size_t k=0;k<h;k++){
+					unsigned u=a[i+k],v=a[i+k+h];
+					a[i+k]=u+v>=MOD?u+v-MOD:u+v;
+					a[i+k+h]=montMul(u>=v?u-v:u+MOD-v,rt[h+k]);
+				}
+		return;
+	}
+	for(size_t h=1;h<n;h*=2)
+		for(size_t i=0;i<n;i+=2*h)
+			for(size_t k=0;k<h;k++){
+				unsigned u=a[i+k],v=montMul(a[i+k+h],irt[h+k]);
+				a[i+k]=u+v>=MOD?u+v-MOD:u+v;
+				a[i+k+h]=u>=v?u-v:u+MOD-v;
+			}
+	unsigned long long inv=power(n,MOD-2);
+	for(auto&x:a)x=(unsigned)(x*inv%MOD);
+}
+
+//a*b的前need项
+vector<unsigned> multiply(vector<unsigned>a,vector<unsigned>b,size_t need){
+	size_t n=1;
+	while(n<a.size()+b.size())n<<=1;
+	a.resize(n);
+	b.resize(n);
+	ntt(a,false);
+	ntt(b,false);
+	for(size_t i=0;i<n;i++)a[i]=(unsigned)((unsigned long long)a[i]*b[i]%MOD);
+	ntt(a,true);
+	a.resize(need);
+	return a;
+}
+
+//牛顿迭代求逆：b=b*(2-a*b)，每轮精度翻倍。a取前len项、b有len/2项，a*b*b不超过2len项，
+//在长度2len的变换域里逐点算b*(2-a*b)，一轮只要三次变换
+vector<unsigned> polyInv(const vector<unsigned>&a,size_t n){
+	vector<unsigned>b{(unsigned)power(a[0],MOD-2)};
+	for(size_t len=1;len<n;){
+		len*=2;
+		vector<unsigned>fa(a.begin(),a.begin()+min(len,a.size()));
+		fa.resize(2*len);
+		b.resize(2*len);
+		ntt(fa,false);
+		ntt(b,false);
+		for(size_t i=0;i<2*len;i++){
+			unsigned ab=(unsigned)((unsigned long long)fa[i]*b[i]%MOD);
+			b[i]=(unsigned)((unsigned long long)b[i]*((2+MOD-ab)%MOD)%MOD);
+		}
+		ntt(b,true);
+		b.resize(len);
+	}
+	b.resize(n);
+	return b;
+}
+
+//ln a=∫a'/a，要求a[0]=1
+vector<unsigned> polyLog(const vector<unsigned>&a,size_t n,const vector<unsigned>&inv){
+	vector<unsigned>d(n);
+	for(size_t i=1;i<n&&i<a.size();i++)d[i-1]=(unsigned)((unsigned long long)a[i]*i%MOD);
+	vector<unsigned>q=multiply(d,polyInv(a,n),n),r(n);
+	for(size_t i=1;i<n;i++)r[i]=(unsigned)((unsigned long long)q[i-1]*inv[i]%MOD);
+	return r;
+}
+
+//牛顿迭代求exp：b=b*(1-ln b+a)，要求a[0]=0
+vector<unsigned> polyExp(const vector<unsigned>&a,size_t n,const vector<unsigned>&inv){
+	vector<unsigned>b{1};
+	for(size_t len=1;len<n;){
+		len*=2;
+		vector<unsigned>t=polyLog(b,len,inv);
+		for(size_t i=0;i<len;i++){
+			unsigned ai=i<a.size()?a[i]:0;
+			t[i]=(ai+MOD-t[i])%MOD;
+		}
+		t[0]=(t[0]+1)%MOD;
+		b=multiply(b,t,len);
+	}
+	b.resize(n);
+	return b;
+}
+
+//凑出0..w每个金额的方案数（模MOD），即∏1/(1-x^a)的各项系数。
+//取对数后ln∏1/(1-x^a)=Σ_a Σ_k x^(ak)/k，x^j的系数是(1/j)*Σ_{a|j}a，按面额枚举倍数是调和级数O(w log w)，
+//再做一次多项式exp，总共O(w log w)。面额少或w超出NTT长度时直接DP，O(n*w)
+vector<unsigned> countWays(const vector<long long>&a,long long w){
+	size_t n=w+1;
+	if((long long)a.size()<=WAYS_DP_MAX||n>(1u<<22)){
+		vector<unsigned>g(n);
+		g[0]=1;
+		for(long long c:a)
+			for(long long j=c;j<=w;j++){
+				g[j]+=g[j-c];
+				if(g[j]>=MOD)g[j]-=MOD;
+			}
+		return g;
+	}
+	vector<unsigned>inv(2*n+1);
+	inv[1]=1;
+	for(size_t i=2;i<inv.size();i++)inv[i]=(unsigned)((unsigned long long)(MOD-MOD/i)*inv[MOD%i]%MOD);
+	vector<unsigned long long>sum(n);
+	for(long long c:a)
+		for(long long j=c;j<=w;j+=c)sum[j]+=c;
+	vector<unsigned>l(n);
+	for(size_t j=1;j<n;j++)l[j]=(unsigned)(sum[j]%MOD*inv[j]%MOD);
+	return polyExp(l,n,inv);
+}
+
+//输入：n w和n个面额，输出0..w每个金额的方案数，每行一个
+void waysMode(){
+	long long n=0,w=0;
+	readLL(n);
+	readLL(w);
+	vector<long long>a;
+	readNotes(n,a);
+	while(!a.empty()&&a.back()>w)a.pop_back();
+	if(w<0)return;
+	vector<unsigned>g=countWays(a,w);
+	string out;
+	for(unsigned v:g){
+		out+=to_string(v);
+		out+='\n';
+		if(out.size()>(1<<16)){
+			cout<<out;
+			out.clear();
+		}
+	}
+	cout<<out;
+}
+
+#ifndef NO_MAIN//基准测试直接包含本文件时不要main
+int main(int argc,char**argv){
+	ios::sync_with_stdio(false);
+	if(argc>1&&strcmp(argv[1],"--batch")==0){
+		batchMode();
+		return 0;
+	}
+	if(argc>1&&strcmp(argv[1],"--bounded")==0){
+		boundedMode();
+		return 0;
+	}
+	if(argc>1&&strcmp(argv[1],"--huge")==0){
+		hugeMode();
+		return 0;
+	}
+	if(argc>1&&strcmp(argv[1],"--ways")==0){
+		waysMode();
+		return 0;
+	}
+	int threads=1;//--threads N：单个大金额时用多线程波前填表，N为0时取CPU核数
+	if(argc>2&&strcmp(argv[1],"--threads")==0){
+		threads=atoi(argv[2]);
+		if(threads<=0)threads=max(1u,thread::hardware_concurrency());
+	}
+	long long n=0,w=0;
+	readLL(n);
+	readLL(w);
+	vector<long long>a;
+	readNotes(n,a);
+	while(!a.empty()&&a.back()>w)a.pop_back();//比w大的面额用不上
+	if(w<0){
+		cout<<NONE<<endl;
+		return 0;
+	}
+	long long most=a.empty()?0:w/a[0];
+	long long ans;
+	switch(pickWidth(most)){
+		case 8:ans=minNotes<uint8_t>(a,w,threads);break;
+		case 16:ans=minNotes<uint16_t>(a,w,threads);break;
+		case 32:ans=minNotes<uint32_t>(a,w,threads);break;
+		default:ans=minNotes<uint64_t>(a,w,threads);break;
+	}
+	cout<<ans<<endl;
 	return 0;
-} 
\ No newline at end of file
+}
+#endif